@@ -0,0 +1,64 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""Frame index sidecars of the noise kits' logs (LOG_XXXX.IDX next to LOG_XXXX.BIN).
+
+The firmware appends a (timestamp, offset) entry for every LOG_INDEX_EVERY-th
+frame record (FFT2, FFT3, FFTB, FFTQ) once the record is on the card.
+seek_window() binary-searches it for the part of a log file that can hold a
+time window, so a reader starts there instead of walking every header.
+"""
+
+import os, struct
+from bisect import bisect_left
+
+IDX_HDR_FMT    = "<4sB B H 8s"   # magic "LIDX",version,res,every,res
+IDX_HDR_SIZE   = struct.calcsize(IDX_HDR_FMT)
+IDX_ENTRY_FMT  = "<Q I 4s"       # frame timestamp,record offset,res
+IDX_ENTRY_SIZE = struct.calcsize(IDX_ENTRY_FMT)
+
+def index_path(log_path):
+    """Sidecar of log_path, or None if there is none."""
+    root, ext = os.path.splitext(log_path)
+    for cand in (root + (".IDX" if ext.isupper() else ".idx"), root + ".IDX", root + ".idx"):
+        if os.path.isfile(cand):
+            return cand
+    return None
+
+def read_log_index(log_path):
+    """(timestamps, offsets) of log_path's sidecar; None if missing or not an index."""
+    path = index_path(log_path)
+    if path is None:
+        return None
+    with open(path, "rb") as f:
+        data = f.read()
+    if len(data) < IDX_HDR_SIZE or data[:4] != b"LIDX":
+        return None
+    n = (len(data) - IDX_HDR_SIZE) // IDX_ENTRY_SIZE
+    entries = struct.iter_unpack(IDX_ENTRY_FMT, data[IDX_HDR_SIZE:IDX_HDR_SIZE + n * IDX_ENTRY_SIZE])
+    ts, offsets = [], []
+    for t, o, _ in entries:
+        ts.append(t)
+        offsets.append(o)
+    return ts, offsets
+
+def seek_window(log_path, first, end, start_ep, end_ep, tail_s=0):
+    """Byte range [lo, hi) within the records [first, end) of log_path that holds
+    every record of [start_ep, end_ep): from the last indexed frame before start_ep
+    to the first indexed frame at or after end_ep + tail_s. Records written after
+    their period (VSUM, LSUM) need tail_s to cover the delay. Returns (first, end)
+    without a usable sidecar, or if the timestamps go backwards (clock stepped)."""
+    idx = read_log_index(log_path)
+    if not idx:
+        return first, end
+    pairs = [(t, o) for t, o in zip(*idx) if first <= o < end]
+    if not pairs:
+        return first, end
+    ts = [t for t, _ in pairs]
+    offsets = [o for _, o in pairs]
+    if any(b < a for a, b in zip(ts, ts[1:])) or any(b <= a for a, b in zip(offsets, offsets[1:])):
+        return first, end
+    i = bisect_left(ts, start_ep)
+    j = bisect_left(ts, end_ep + tail_s)
+    lo = offsets[i - 1] if i > 0 else first
+    hi = offsets[j] if j < len(ts) else end
+    return lo, hi
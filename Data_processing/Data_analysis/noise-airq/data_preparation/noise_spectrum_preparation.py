@@ -6,6 +6,7 @@ from pathlib import Path
 import numpy as np
 import pandas as pd
 from multiprocessing import Pool, cpu_count
+from log_index import seek_window
 
 # ===================== CONFIG (edit) =====================
 INPUT_DIRS = [
@@ -14,6 +15,14 @@ INPUT_DIRS = [
 KIT_CODE    = "NOISE102"
 YAML_PATH   = r"config\time_window_unified.yaml"
 OUT_PARQ    = r"data\processed\noise_voice_1min.parquet"
+OUT_PARQ_HOURLY = r"data\processed\noise_levels_1h.parquet"   # device L10/L50/L90 per hour (LSUM)
+# Build the minute table from the kits' own minute summaries (VSUM records)
+# instead of re-deriving it from every spectrum: FFT2 payloads are skipped unread.
+FROM_DEVICE_MINUTES = False
+# Start each log file at the window through its LOG_XXXX.IDX sidecar (files without one are scanned whole).
+# LSUM hours are logged when they close, so parsing runs this long past the window end.
+USE_LOG_INDEX = True
+INDEX_TAIL_S  = 3600 + 60
 # ========================================================
 
 # ====== Analysis config
@@ -42,9 +51,116 @@ SECTOR   = 512
 HDR_FMT  = "<4sQ B f f H f H 3s"   # magic,ts,voice,snr,energy,peaks,contrast,bins,res
 HDR_SIZE = struct.calcsize(HDR_FMT)
 
+# res[0]: pooling policy (FFT_POOL_* in fft_engine.h); 0 on logs that predate it
+POOL_MIXED, POOL_MAX, POOL_MEAN_MAG, POOL_WELCH_PSD, POOL_MEDIAN = range(5)
+POOL_NAMES = {POOL_MIXED: "mixed", POOL_MAX: "max", POOL_MEAN_MAG: "mean_mag",
+              POOL_WELCH_PSD: "welch_psd", POOL_MEDIAN: "median"}
+
+# Preallocated log files (LOG_PREALLOCATE): sector 0 holds the write pointer; past it is stale card data
+LOGH_FMT  = "<4sB3s I I Q"            # magic "LOGH",version,res,file size,end of records,ts
+LOGH_SIZE = struct.calcsize(LOGH_FMT)
+
+# Compact spectrum frames (FFT_LOG_RECORD == FFT_LOG_COMPACT): magnitudes only, coded per frame
+FFT3_FMT  = "<4sQ B B B B H H f f f f f I H H f f f 4s"   # magic "FFT3",ts,version,encoding,pool,voice,bins,peaks,
+FFT3_SIZE = struct.calcsize(FFT3_FMT)                        # snr,energy,contrast,scale,step_db,fs,fft_size,step,intensity,laeq,sfm,res
+ENC_F16, ENC_LOG8 = 0, 1
+# ... preceded in each file by its frequency grid (bins float32 after the header)
+GRID_FMT  = "<4sQ B B H I H H 8s"     # magic "FGRD",ts,version,pool,bins,fs,fft_size,step,res
+GRID_SIZE = struct.calcsize(GRID_FMT)
+
+# Quiet frames (FFT_QUIET_GATE): every window gated, level statistics only, one sector
+QUIET_FMT  = "<4sQ f f f 8s"      # magic "FFTQ",ts,levelRMS (V),zcr (Hz),noiseFloor (V),res
+QUIET_SIZE = struct.calcsize(QUIET_FMT)
+
+# Band frames (FFT_LOG_RECORD == FFT_LOG_BANDS): LAeq + 1/3-octave band levels, dB
+BAND_FMT  = "<4sQ B B B b f f f 4s"   # magic "FFTB",ts,voice,pool,n_bands,first_band,laeq,snr,intensity,res
+BAND_SIZE = struct.calcsize(BAND_FMT)
+BAND_COLUMNS = ["kit_code","ts_unix","voice","laeq_db"]
+
+# Level-meter seconds (LEVEL_METER_ENABLED): header + n 32-byte entries, one sector
+LEVEL_FMT  = "<4sB3s f f 16s"          # magic "LVL1",n,res,fast tau (s),slow tau (s),res
+LEVEL_SIZE = struct.calcsize(LEVEL_FMT)
+LEVEL_ENTRY_FMT  = "<Q f f f f f I"    # ts,LAeq,LAFmax,LAFmin,LASmax,LASmin (dB),samples
+LEVEL_ENTRY_SIZE = struct.calcsize(LEVEL_ENTRY_FMT)
+LEVEL_COLUMNS = ["kit_code","ts_unix","meter_laeq_db","lafmax_db","lafmin_db","lasmax_db","lasmin_db"]
+
+# Statistical level summaries (LEVEL_STATS_ENABLED): one per closed minute / hour, one sector
+SUMMARY_FMT  = "<4sQ B 3s I f f f f f f"   # magic "LSUM",start,period,res,count,L10,L50,L90,Leq,min,max
+SUMMARY_SIZE = struct.calcsize(SUMMARY_FMT)
+PERIOD_MINUTE, PERIOD_HOUR = 0, 1
+SUMMARY_COLUMNS = ["kit_code","period","ts_unix","stat_frames",
+                   "l10_db","l50_db","l90_db","stat_leq_db","stat_min_db","stat_max_db"]
+
+# Minute voice summaries (MINUTE_SUMMARY_ENABLED): per_kit_worker()'s statistics computed on the kit
+VSUM_FMT  = "<4sQ H H H B B f f f f f f f"   # magic "VSUM",start,frames,voice,quiet,pool,res,intensity,score,snr,sfm,noiseRMS,bandRMS,levelRMS
+VSUM_SIZE = struct.calcsize(VSUM_FMT)
+VSUM_COLUMNS = ["kit_code","ts_unix","frames","voice_frames","quiet_frames",
+                "intensity_mean","voice_score_mean","snr_mean","sfm_mean",
+                "noiseRMS_mean","bandRMS_mean","level_rms_mean"]
+
+def band_center_hz(k):
+    """Exact base-10 centre of 1/3-octave band k (k = 0 → 1 kHz)."""
+    return 1000.0 * 10.0 ** (k / 10.0)
+
+FRAME_COLUMNS = ["kit_code","file_name","frame_id","ts_unix",
+                 "sum_band","sum_all","n_band","n_all","sum_mag_band","sum_log_mag_band",
+                 "quiet","level_rms","zcr_hz"]
+
 def aligned_up(n, a=SECTOR):
     return ((n + a - 1) // a) * a
 
+def log_data_range(f, size):
+    """(first, end) byte offsets of the records in an open LOG_*.BIN."""
+    f.seek(0)
+    head = f.read(LOGH_SIZE)
+    if len(head) == LOGH_SIZE and head[:4] == b"LOGH":
+        _, _, _, _, end, _ = struct.unpack(LOGH_FMT, head)
+        return SECTOR, min(end, size)
+    return 0, size
+
+def read_grid(f, offset):
+    """(frequencies or None, bins) of the FGRD record at offset."""
+    f.seek(offset)
+    hdr = f.read(GRID_SIZE)
+    if len(hdr) < GRID_SIZE or hdr[:4] != b"FGRD":
+        return None, 0
+    _, _, _, _, n_bins, _, _, _, _ = struct.unpack(GRID_FMT, hdr)
+    raw = f.read(n_bins * 4)
+    if len(raw) < n_bins * 4:
+        return None, n_bins
+    return np.frombuffer(raw, dtype="<f4").astype(np.float64), n_bins
+
+def decode_compact(payload, encoding, scale, step_db):
+    """FFT3 magnitudes (spectrum_codec.cpp) back to float64."""
+    if encoding == ENC_F16:
+        return np.frombuffer(payload, dtype="<f2").astype(np.float64) * scale
+    codes = np.frombuffer(payload, dtype=np.uint8).astype(np.float64)
+    return np.where(codes > 0, scale * np.power(10.0, (codes - 255.0) * step_db / 20.0), 0.0)
+
+def spectrum_row(kit_code, file_name, frame_id, ts, freqs, mags, pool):
+    """Summary row of one spectrum frame (FFT2 or FFT3)."""
+    if pool == POOL_WELCH_PSD:
+        mags = np.sqrt(mags)   # PSD (V^2/Hz) → ASD, so the magnitude features keep their shape
+
+    in_band = (freqs >= VOICE_MIN_HZ) & (freqs <= VOICE_MAX_HZ)
+
+    sum_all  = float(np.sum(mags * mags, dtype=np.float64))
+    n_all    = int(mags.size)
+    m_band   = mags[in_band]
+    sum_band = float(np.sum(m_band * m_band, dtype=np.float64))
+    n_band   = int(m_band.size)
+
+    sum_mag_band     = float(np.sum(m_band, dtype=np.float64))
+    sum_log_mag_band = float(np.sum(np.log(np.maximum(m_band, EPS)), dtype=np.float64))
+
+    if n_all  == 0: n_all  = 1
+    if n_band == 0: n_band = 1
+
+    return (kit_code, file_name, frame_id, int(ts),
+            sum_band, sum_all, n_band, n_all,
+            sum_mag_band, sum_log_mag_band,
+            0, np.nan, np.nan)
+
 def load_window(yaml_file):
     with open(yaml_file, "r") as f:
         cfg = yaml.safe_load(f)
@@ -67,9 +183,18 @@ def find_log_files(input_dir):
     return files
 
 # =================== Streaming aggregator ===================
-def stream_frames_to_summaries(input_dirs, kit_code, start_ep, end_ep):
+def stream_frames_to_summaries(input_dirs, kit_code, start_ep, end_ep, spectra=True):
+    """Spectrum/quiet frames (FFT2, FFT3, FFTQ) as summary rows, band frames (FFTB) as level rows,
+    level-meter seconds (LVL1) as one row per second, L10/L50/L90 summaries (LSUM)
+    and minute voice summaries (VSUM). spectra=False skips the frames unread."""
     rows = []
+    band_rows = []
+    level_rows = []
+    summary_rows = []
+    minute_rows = []
+    band_files = set()
     next_frame_id = 0
+    policies = set()
 
     for idir in input_dirs:
         logs = find_log_files(idir)
@@ -82,17 +207,120 @@ def stream_frames_to_summaries(input_dirs, kit_code, start_ep, end_ep):
             file_name = os.path.basename(path)
             print(f"[INFO] Parsing {file_name} ... size={size/1e6:.2f} MB")
             with open(path, "rb") as f:
-                offset = 0
+                offset, size = log_data_range(f, size)
+                grid = None   # FGRD frequencies for this file's FFT3 frames
+                if USE_LOG_INDEX:
+                    lo, hi = seek_window(path, offset, size, start_ep, end_ep, INDEX_TAIL_S)
+                    if (lo, hi) != (offset, size):
+                        print(f"[INFO] {file_name}: index → {(hi - lo)/1e6:.2f} of {(size - offset)/1e6:.2f} MB")
+                        if lo > offset:
+                            grid, _ = read_grid(f, offset)   # the file's first record, skipped by the seek
+                        offset, size = lo, hi
                 while offset + HDR_SIZE <= size:
                     f.seek(offset)
                     hdr = f.read(HDR_SIZE)
                     if len(hdr) < HDR_SIZE:
                         break
-                    magic, ts, voice, snr, energy, peaks, contrast, bins, _res = struct.unpack(HDR_FMT, hdr)
-
+                    magic, ts, voice, snr, energy, peaks, contrast, bins, res = struct.unpack(HDR_FMT, hdr)
+
+                    if magic == b"VSUM":
+                        f.seek(offset)
+                        rec = f.read(VSUM_SIZE)
+                        if len(rec) < VSUM_SIZE:
+                            break
+                        _, start, n_frames, n_voice, n_quiet, _, _, *means = struct.unpack(VSUM_FMT, rec)
+                        if start_ep <= start < end_ep:
+                            minute_rows.append((kit_code, int(start), n_frames, n_voice, n_quiet, *means))
+                        offset += SECTOR
+                        continue
+                    if not spectra and magic == b"FFT2":
+                        offset += aligned_up(HDR_SIZE + bins * 8, SECTOR)
+                        continue
+                    if magic == b"FGRD":
+                        grid, n_bins = read_grid(f, offset)
+                        offset += aligned_up(GRID_SIZE + n_bins * 4, SECTOR)
+                        continue
+                    if magic == b"FFT3":
+                        f.seek(offset)
+                        rec = f.read(FFT3_SIZE)
+                        if len(rec) < FFT3_SIZE:
+                            break
+                        (_, ts, _, encoding, pool, _, n_bins, _, _, _, _,
+                         scale, step_db, fs, fft_size, _, _, _, _, _) = struct.unpack(FFT3_FMT, rec)
+                        data_bytes = n_bins * (2 if encoding == ENC_F16 else 1)
+                        offset_next = offset + aligned_up(FFT3_SIZE + data_bytes, SECTOR)
+                        if not spectra or ts < start_ep or ts >= end_ep:
+                            offset = offset_next
+                            continue
+                        payload = f.read(data_bytes)
+                        if len(payload) < data_bytes:
+                            break
+                        if pool not in policies:
+                            policies.add(pool)
+                            print(f"[INFO] {file_name}: pooling policy {POOL_NAMES.get(pool, pool)}")
+                        freqs = grid if grid is not None and grid.size == n_bins \
+                            else np.arange(n_bins, dtype=np.float64) * fs / fft_size
+                        mags = decode_compact(payload, encoding, scale, step_db)
+                        rows.append(spectrum_row(kit_code, file_name, next_frame_id, ts, freqs, mags, pool))
+                        next_frame_id += 1
+                        offset = offset_next
+                        continue
+                    if magic == b"FFTQ":
+                        if not spectra:
+                            offset += SECTOR
+                            continue
+                        _, ts, level_rms, zcr_hz, _, _ = struct.unpack(QUIET_FMT, hdr[:QUIET_SIZE])
+                        if start_ep <= ts < end_ep:
+                            rows.append((
+                                kit_code, file_name, next_frame_id, int(ts),
+                                0.0, 0.0, 1, 1, 0.0, 0.0,
+                                1, float(level_rms), float(zcr_hz)
+                            ))
+                            next_frame_id += 1
+                        offset += SECTOR
+                        continue
+                    if magic == b"FFTB":
+                        _, ts, voice, pool, n_bands, first_band, laeq, _, _, _ = struct.unpack(BAND_FMT, hdr[:BAND_SIZE])
+                        raw_size = BAND_SIZE + n_bands * 4
+                        if start_ep <= ts < end_ep:
+                            f.seek(offset + BAND_SIZE)
+                            levels = struct.unpack(f"<{n_bands}f", f.read(n_bands * 4))
+                            band_rows.append((kit_code, int(ts), int(voice), float(laeq)) + levels)
+                            if file_name not in band_files:
+                                band_files.add(file_name)
+                                print(f"[INFO] {file_name}: band frames, {n_bands} bands from "
+                                      f"{band_center_hz(first_band):.0f} Hz, pooling policy {POOL_NAMES.get(pool, pool)}")
+                        offset += aligned_up(raw_size, SECTOR)
+                        continue
+                    if magic == b"LVL1":
+                        _, n_sec, _, _, _, _ = struct.unpack(LEVEL_FMT, hdr[:LEVEL_SIZE])
+                        f.seek(offset + LEVEL_SIZE)
+                        entries = f.read(n_sec * LEVEL_ENTRY_SIZE)
+                        for i in range(len(entries) // LEVEL_ENTRY_SIZE):
+                            ts, laeq, lafmax, lafmin, lasmax, lasmin, _ = struct.unpack_from(
+                                LEVEL_ENTRY_FMT, entries, i * LEVEL_ENTRY_SIZE)
+                            if start_ep <= ts < end_ep:
+                                level_rows.append((kit_code, int(ts), laeq, lafmax, lafmin, lasmax, lasmin))
+                        offset += aligned_up(LEVEL_SIZE + n_sec * LEVEL_ENTRY_SIZE, SECTOR)
+                        continue
+                    if magic == b"LSUM":
+                        f.seek(offset)
+                        rec = f.read(SUMMARY_SIZE)
+                        if len(rec) < SUMMARY_SIZE:
+                            break
+                        _, start, period, _, count, l10, l50, l90, leq, lmin, lmax = struct.unpack(SUMMARY_FMT, rec)
+                        if start_ep <= start < end_ep:
+                            summary_rows.append((kit_code, int(period), int(start), int(count),
+                                                 l10, l50, l90, leq, lmin, lmax))
+                        offset += SECTOR
+                        continue
                     if magic != b"FFT2":
                         offset += SECTOR
                         continue
+                    pool = res[0]
+                    if pool not in policies:
+                        policies.add(pool)
+                        print(f"[INFO] {file_name}: pooling policy {POOL_NAMES.get(pool, pool)}")
 
                     data_bytes = bins * 8
                     payload = f.read(data_bytes)
@@ -115,42 +343,60 @@ def stream_frames_to_summaries(input_dirs, kit_code, start_ep, end_ep):
                     arr = arr.reshape(-1, 2)
                     freqs = arr[:, 0]
                     mags  = arr[:, 1].astype(np.float64, copy=False)
-
-                    in_band = (freqs >= VOICE_MIN_HZ) & (freqs <= VOICE_MAX_HZ)
-
-                    sum_all  = float(np.sum(mags * mags, dtype=np.float64))
-                    n_all    = int(mags.size)
-                    m_band   = mags[in_band]
-                    sum_band = float(np.sum(m_band * m_band, dtype=np.float64))
-                    n_band   = int(m_band.size)
-
-                    sum_mag_band     = float(np.sum(m_band, dtype=np.float64))
-                    sum_log_mag_band = float(np.sum(np.log(np.maximum(m_band, EPS)), dtype=np.float64))
-
-                    if n_all  == 0: n_all  = 1
-                    if n_band == 0: n_band = 1
-
-                    rows.append((
-                        kit_code, file_name, next_frame_id, int(ts),
-                        sum_band, sum_all, n_band, n_all,
-                        sum_mag_band, sum_log_mag_band
-                    ))
+                    rows.append(spectrum_row(kit_code, file_name, next_frame_id, ts, freqs, mags, pool))
                     next_frame_id += 1
 
                     raw_size = HDR_SIZE + data_bytes
                     offset += aligned_up(raw_size, SECTOR)
                     # ---- end vectorized block ----
 
-    if not rows:
-        return pd.DataFrame(columns=[
-            "kit_code","file_name","frame_id","ts_unix",
-            "sum_band","sum_all","n_band","n_all","sum_mag_band","sum_log_mag_band"
-        ])
+    if len(policies) > 1:
+        print(f"[WARN] Mixed pooling policies in input: {sorted(POOL_NAMES.get(p, p) for p in policies)}")
+
+    n_bands = max((len(r) - len(BAND_COLUMNS) for r in band_rows), default=0)
+    bands = pd.DataFrame.from_records(
+        band_rows, columns=BAND_COLUMNS + [f"band_{i:02d}_db" for i in range(n_bands)])
+    levels = pd.DataFrame.from_records(level_rows, columns=LEVEL_COLUMNS)
+    summaries = pd.DataFrame.from_records(summary_rows, columns=SUMMARY_COLUMNS)
+    minutes = pd.DataFrame.from_records(minute_rows, columns=VSUM_COLUMNS)
+    return pd.DataFrame.from_records(rows, columns=FRAME_COLUMNS), bands, levels, summaries, minutes
+
+def band_levels_per_minute(bands):
+    """Energetic (Leq) mean of LAeq and band levels per kit and minute."""
+    if bands.empty:
+        return pd.DataFrame(columns=["kit_code","ts_min_utc","laeq_db","band_frames"])
+    b = bands.copy()
+    b["ts_min_utc"] = pd.to_datetime((b["ts_unix"] // 60) * 60, unit="s", utc=True)
+    level_cols = [c for c in b.columns if c == "laeq_db" or c.startswith("band_")]
+    b[level_cols] = np.power(10.0, b[level_cols].astype("float64") / 10.0)
+    agg = b.groupby(["kit_code","ts_min_utc"], as_index=False).agg(
+        {**{c: "mean" for c in level_cols}, "voice": "size"})
+    agg[level_cols] = (10.0 * np.log10(agg[level_cols])).astype("float32")
+    return agg.rename(columns={"voice": "band_frames"})
+
+def level_seconds_per_minute(levels):
+    """Level-meter seconds per kit and minute: energetic mean of LAeq, extremes of Fast/Slow."""
+    if levels.empty:
+        return pd.DataFrame(columns=["kit_code","ts_min_utc","meter_laeq_db","lafmax_db","lafmin_db",
+                                     "lasmax_db","lasmin_db","level_seconds"])
+    l = levels.copy()
+    l["ts_min_utc"] = pd.to_datetime((l["ts_unix"] // 60) * 60, unit="s", utc=True)
+    l["meter_laeq_db"] = np.power(10.0, l["meter_laeq_db"].astype("float64") / 10.0)
+    agg = l.groupby(["kit_code","ts_min_utc"], as_index=False).agg(
+        meter_laeq_db=("meter_laeq_db", "mean"), lafmax_db=("lafmax_db", "max"),
+        lafmin_db=("lafmin_db", "min"), lasmax_db=("lasmax_db", "max"),
+        lasmin_db=("lasmin_db", "min"), level_seconds=("ts_unix", "size"))
+    agg["meter_laeq_db"] = (10.0 * np.log10(agg["meter_laeq_db"])).astype("float32")
+    return agg
 
-    return pd.DataFrame.from_records(rows, columns=[
-        "kit_code","file_name","frame_id","ts_unix",
-        "sum_band","sum_all","n_band","n_all","sum_mag_band","sum_log_mag_band"
-    ])
+def level_summaries(summaries, period):
+    """Device L10/L50/L90 summaries of one period (PERIOD_MINUTE/PERIOD_HOUR), keyed by period start."""
+    key = "ts_min_utc" if period == PERIOD_MINUTE else "ts_hour_utc"
+    s = summaries.loc[summaries["period"] == period].drop(columns="period")
+    # A period is summarized once; keep the last record if a reboot repeated it
+    s = s.drop_duplicates(subset=["kit_code","ts_unix"], keep="last")
+    s[key] = pd.to_datetime(s["ts_unix"], unit="s", utc=True)
+    return s.drop(columns="ts_unix")
 
 # =================== Feature construction ===================
 def to_frame_features(ff):
@@ -176,7 +422,12 @@ def to_frame_features(ff):
     snr_lin = (bandRMS / noiseRMS) ** 2
     snr_lin = np.clip(snr_lin, 0, SNR_CAP)
 
-    out = ff[["kit_code","file_name","frame_id","ts_unix"]].copy()
+    # Quiet frames have no spectrum: flat, no SNR
+    quiet = ff["quiet"].astype(bool)
+    sfm     = sfm.where(~quiet, 1.0)
+    snr_lin = snr_lin.where(~quiet, 0.0)
+
+    out = ff[["kit_code","file_name","frame_id","ts_unix","quiet","level_rms","zcr_hz"]].copy()
     out["bandRMS"]  = bandRMS.astype("float32")
     out["noiseRMS"] = noiseRMS.astype("float32")
     out["sfm"]      = sfm.astype("float32")
@@ -196,10 +447,15 @@ def stateful_detect_one_kit(g):
     if g.empty:
         return pd.DataFrame(columns=[
             "ts_unix","voice","voiceIntensityDB","voice_score",
-            "snr_lin","sfm","noiseRMS","bandRMS"
+            "snr_lin","sfm","noiseRMS","bandRMS","quiet","level_rms"
         ])
 
-    init = g["bandRMS"].head(20).median() if len(g) >= 5 else float(g["bandRMS"].iloc[0])
+    # Baseline seed from spectral frames only (quiet frames carry bandRMS = 0)
+    spectral = g.loc[g["quiet"] == 0, "bandRMS"]
+    if spectral.empty:
+        spectral = g["bandRMS"]
+
+    init = spectral.head(20).median() if len(spectral) >= 5 else float(spectral.iloc[0])
     baseline = float(max(init, EPS))
 
     n = len(g)
@@ -210,9 +466,14 @@ def stateful_detect_one_kit(g):
     brms = g["bandRMS"].to_numpy(np.float32, copy=False)
     sfm  = np.nan_to_num(g["sfm"].to_numpy(np.float32, copy=False), nan=1.0)
     snr  = np.nan_to_num(g["snr_lin"].to_numpy(np.float32, copy=False), nan=0.0)
+    quiet = g["quiet"].to_numpy(np.int8, copy=False)
 
     confirm = 0
     for i in range(n):
+        if quiet[i]:
+            # Gated on the device: no voice, confirmation restarts, baseline kept
+            confirm = 0
+            continue
         rise_db = max(20.0 * math.log10((float(brms[i]) + EPS) / (baseline + EPS)), 0.0)
         cand = (snr[i] >= SNR_MIN_LINEAR) and (sfm[i] <= SFM_MAX_FOR_VOICE) and (rise_db >= RISE_DB_OVER_BASE)
         confirm = confirm + 1 if cand else 0
@@ -228,7 +489,7 @@ def stateful_detect_one_kit(g):
         if v == 0:
             baseline = (1.0-BASELINE_ALPHA)*baseline + BASELINE_ALPHA*max(float(brms[i]), EPS)
 
-    out = g[["ts_unix","snr_lin","sfm","noiseRMS","bandRMS"]].copy()
+    out = g[["ts_unix","snr_lin","sfm","noiseRMS","bandRMS","quiet","level_rms"]].copy()
     out["voice"] = voice
     out["voiceIntensityDB"] = inten
     out["voice_score"] = score
@@ -250,9 +511,28 @@ def per_kit_worker(args):
                 sfm_mean=("sfm","mean"),
                 noiseRMS_mean=("noiseRMS","mean"),
                 bandRMS_mean=("bandRMS","mean"),
+                level_rms_mean=("level_rms","mean"),
                 frames=("voice","size"),
-                voice_frames=("voice","sum")))
-
+                voice_frames=("voice","sum"),
+                quiet_frames=("quiet","sum")))
+    return finish_minute_table(agg, kit, frame_period_s, start_ep, end_ep, tz_name)
+
+def device_minutes_to_agg(minutes, start_ep, end_ep, tz_name):
+    """Minute table from the kits' VSUM records (same columns as per_kit_worker())."""
+    parts = []
+    for kit, m in minutes.groupby("kit_code"):
+        # A reboot can repeat a minute: keep its last summary
+        m = m.drop_duplicates(subset=["ts_unix"], keep="last").copy()
+        m["ts_min_utc"] = pd.to_datetime(m["ts_unix"], unit="s", utc=True)
+        m["voice_rate"] = (m["voice_frames"] / m["frames"].clip(lower=1)).astype("float32")
+        # No frame timestamps here: the busiest minute gives the frame period
+        frame_period_s = 60.0 / float(m["frames"].max())
+        parts.append(finish_minute_table(m.drop(columns="ts_unix"), kit, frame_period_s,
+                                         start_ep, end_ep, tz_name))
+    return pd.concat(parts, ignore_index=True)
+
+def finish_minute_table(agg, kit, frame_period_s, start_ep, end_ep, tz_name):
+    """Coverage columns and the full minute grid for one kit's per-minute aggregates."""
     # Clamp coverage to 60 s
     agg["frame_period_s"] = frame_period_s
     agg["coverage_s"]     = np.minimum(agg["frames"] * frame_period_s, 60.0)
@@ -275,7 +555,7 @@ def per_kit_worker(args):
 
     agg = grid.merge(agg, on=["kit_code","ts_min_utc"], how="left")
 
-    for col in ["frames","voice_frames"]:
+    for col in ["frames","voice_frames","quiet_frames"]:
         agg[col] = agg[col].fillna(0).astype("int32")
     for col in ["coverage_s","coverage_rate","voice_seconds","voice_rate","voice_rate_time"]:
         agg[col] = agg[col].fillna(0.0).astype("float32")
@@ -289,11 +569,37 @@ def main():
     start_ep, end_ep, tz_name = load_window(YAML_PATH)
     Path(OUT_PARQ).parent.mkdir(parents=True, exist_ok=True)
 
-    ff_raw = stream_frames_to_summaries(INPUT_DIRS, KIT_CODE, start_ep, end_ep)
+    ff_raw, bands, levels, summaries, minutes = stream_frames_to_summaries(
+        INPUT_DIRS, KIT_CODE, start_ep, end_ep, spectra=not FROM_DEVICE_MINUTES)
+    hourly = level_summaries(summaries, PERIOD_HOUR)
+    if not hourly.empty:
+        Path(OUT_PARQ_HOURLY).parent.mkdir(parents=True, exist_ok=True)
+        hourly["ts_hour_local"] = hourly["ts_hour_utc"].dt.tz_convert(tz_name)
+        hourly.to_parquet(OUT_PARQ_HOURLY, index=False)
+        print(f"[INFO] Wrote {len(hourly)} hourly L10/L50/L90 summaries to {OUT_PARQ_HOURLY}")
+    level_tables = [t for t in (band_levels_per_minute(bands), level_seconds_per_minute(levels),
+                                level_summaries(summaries, PERIOD_MINUTE)) if not t.empty]
+    if FROM_DEVICE_MINUTES and not minutes.empty:
+        agg = device_minutes_to_agg(minutes, start_ep, end_ep, tz_name)
+        for t in level_tables:
+            agg = agg.merge(t, on=["kit_code","ts_min_utc"], how="left")
+        agg.to_parquet(OUT_PARQ, index=False)
+        print(f"[DONE] Saved {OUT_PARQ} from {len(minutes):,} device minute summaries  rows={len(agg):,}")
+        return
+    if FROM_DEVICE_MINUTES:
+        print("[WARN] No VSUM records in window; set FROM_DEVICE_MINUTES = False to aggregate spectra")
+    if ff_raw.empty and level_tables:
+        level_min = level_tables[0]
+        for t in level_tables[1:]:
+            level_min = level_min.merge(t, on=["kit_code","ts_min_utc"], how="outer")
+        level_min["ts_min_local"] = level_min["ts_min_utc"].dt.tz_convert(tz_name)
+        level_min.to_parquet(OUT_PARQ, index=False)
+        print(f"[DONE] Level records only; wrote per-minute levels to {OUT_PARQ}")
+        return
     if ff_raw.empty:
         cols = ["kit_code","ts_min_utc","ts_min_local","voice_rate","voice_rate_time",
                 "intensity_mean","voice_score_mean","snr_mean","sfm_mean",
-                "noiseRMS_mean","bandRMS_mean","frames","voice_frames",
+                "noiseRMS_mean","bandRMS_mean","level_rms_mean","frames","voice_frames","quiet_frames",
                 "frame_period_s","coverage_s","coverage_rate","voice_seconds"]
         pd.DataFrame(columns=cols).to_parquet(OUT_PARQ, index=False)
         print(f"[DONE] No frames in window; wrote empty {OUT_PARQ}")
@@ -305,7 +611,7 @@ def main():
     kits = list(ff["kit_code"].unique())
     tasks = []
     for k in kits:
-        g = ff.loc[ff["kit_code"] == k, ["ts_unix","bandRMS","noiseRMS","sfm","snr_lin"]].copy()
+        g = ff.loc[ff["kit_code"] == k, ["ts_unix","bandRMS","noiseRMS","sfm","snr_lin","quiet","level_rms"]].copy()
         tasks.append((k, g, start_ep, end_ep, tz_name))
 
     print(f"[INFO] Kits: {len(kits)} | Frames total: {len(ff):,}")
@@ -317,6 +623,9 @@ def main():
     else:
         agg = pd.concat([per_kit_worker(t) for t in tasks], ignore_index=True)
 
+    for t in level_tables:
+        agg = agg.merge(t, on=["kit_code","ts_min_utc"], how="left")
+
     try:
         agg.to_parquet(OUT_PARQ, index=False, engine="pyarrow")
     except Exception:
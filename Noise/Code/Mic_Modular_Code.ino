@@ -7,6 +7,12 @@
 #include "audio_sampler.h"
 #include "fft_engine.h"
 #include "fft_logger.h"
+#include "level_meter.h"
+#include "level_stats.h"
+#include "minute_summary.h"
+#include "frame_pool.h"
+#include "pipeline_queue.h"
+#include "task_placement.h"
 #include "button_handler.h"
 #include "battery_monitor.h"
 #include "display_manager.h"
@@ -41,14 +47,24 @@ TaskHandle_t batteryTaskHandle;
 TimerHandle_t cycleTimer;
 TimerHandle_t displayTimer;
 
-// === FFT queue ===
-struct FFTFrame {
-  float* frequencies;
-  float* magnitudes;
-  size_t count;
-};
-QueueHandle_t fftQueue;
-#define FFT_QUEUE_LENGTH 4
+// === FFT → logger queue (frame_pool slot indices) ===
+#define FFT_QUEUE_LENGTH   4
+#define FFT_QUEUE_POLICY   BackpressurePolicy::BLOCK   // BLOCK / DROP_NEWEST / DROP_OLDEST
+#define FFT_QUEUE_BLOCK_MS 10                          // BLOCK: wait before dropping the new frame
+static PipelineQueue fftQueue;
+
+// === Pipelining (burst mode) ===
+// true: the next capture starts on the cycle timer while FFT/logging of the
+// previous ones are still running; false: wait for the logger every cycle.
+#define PIPELINE_OVERLAP       true
+#define PIPE_STATS_INTERVAL_MS 60000
+
+// === Sampler → FFT events (burst mode, task notification bits) ===
+#define FFT_EVT_CAPTURE_START  (1u << 0)
+#define FFT_EVT_CAPTURE_DONE   (1u << 1)
+#define FFT_HOP_POLL_MS        10        // hop pickup while a capture runs (~46 ms per hop)
+static volatile uint32_t g_captureSeq  = 0;   // captures started (sampler), tags FFT_EVT_CAPTURE_START
+static volatile uint32_t g_fftOverruns = 0;   // captures the FFT task could not follow or finish
 
 // === Cycle timing diagnostics ===
 static volatile uint32_t g_lastSampleMs = 0;
@@ -92,6 +108,7 @@ static void prepareForDeepSleep() {
 
   // Deinit heavy modules (optional but safe)
   deinitFFTLogger();
+  deinitFramePool();    // slots share the engine's frequency table
   deinitFFTEngine();
 
   vTaskDelay(pdMS_TO_TICKS(50));
@@ -156,11 +173,13 @@ static void tryInitialTimeSyncOrReboot() {
 }
 
 // === Periodic 12h maintenance sync (non-blocking; failures are tolerated) ===
-static void tryPeriodicTimeSync() {
-  time_t now = time(nullptr);
-  if (lastSyncTime == 0) return; // only after a successful initial sync
+static bool isPeriodicTimeSyncDue() {
+  if (lastSyncTime == 0) return false; // only after a successful initial sync
+  return (uint32_t)(time(nullptr) - lastSyncTime) >= TIME_SYNC_INTERVAL_SEC;
+}
 
-  if ((uint32_t)(now - lastSyncTime) < TIME_SYNC_INTERVAL_SEC) return;
+static void tryPeriodicTimeSync() {
+  if (!isPeriodicTimeSyncDue()) return;
 
   Serial.println("[TIME] 12h maintenance time sync — attempting...");
 
@@ -185,12 +204,119 @@ static void tryPeriodicTimeSync() {
   }
 }
 
+// === Periodic background battery check ===
+static void runBatteryAutoCheck(uint32_t& lastAutoCheckMs) {
+  uint32_t nowMs = millis();
+  if ((nowMs - lastAutoCheckMs) < BATTERY_AUTOCHECK_INTERVAL_MS) return;
+  lastAutoCheckMs = nowMs;  // update early to avoid drift on long checks
+
+  // Skip background check while the on-screen battery UI is active.
+  if (!isDisplayActive()) {
+    float v = 0.0f, p = 0.0f;
+    if (checkBatteryStatus(v, p)) {
+      Serial.printf("[BATMON] Auto-check: V=%.3fV, %%=%.1f\n", v, p);
+      if (isBatteryLow()) {
+        showShutdownWarning(v);
+        vTaskDelay(pdMS_TO_TICKS(2000));
+        prepareForDeepSleep();
+        esp_deep_sleep_start();
+      }
+    } else {
+      Serial.println("[BATMON] Auto-check failed (readBattery).");
+    }
+    // STEMMA power handling is internal to checkBatteryStatus()/display manager.
+  } else {
+    Serial.println("[BATMON] Skipped auto-check (UI active).");
+  }
+}
+
+// === Pipeline counters (queue backpressure + frame pool), rate-limited ===
+static void reportPipelineStats(bool force) {
+  static uint32_t lastMs = 0;
+  uint32_t nowMs = millis();
+  if (!force && nowMs - lastMs < PIPE_STATS_INTERVAL_MS) return;
+  lastMs = nowMs;
+  printPipelineQueueStats(fftQueue);
+  printCoreLoad();
+#if CAPTURE_MODE == CAPTURE_MODE_BURST
+  Serial.printf("[FFT] captures=%lu overruns=%lu\n",
+                (unsigned long)g_captureSeq, (unsigned long)g_fftOverruns);
+#endif
+  Serial.printf("[POOL] in use=%lu/%d exhausted=%lu\n",
+                (unsigned long)getFramePoolInUse(), FRAME_POOL_SLOTS,
+                (unsigned long)getFramePoolExhausted());
+#if FFT_QUIET_GATE
+  const QuietGateStats& gate = getQuietGateStats();
+  Serial.printf("[GATE] FFTs run=%lu skipped=%lu quiet frames=%lu floor=%.2f mV\n",
+                (unsigned long)gate.windowsRun, (unsigned long)gate.windowsSkipped,
+                (unsigned long)gate.quietFrames, gate.noiseFloor * 1000.0f);
+#endif
+#if LEVEL_METER_ENABLED
+  const LevelMeterStats level = getLevelMeterStats();
+  Serial.printf("[LEVEL] LAF=%.1f LAS=%.1f dB seconds=%lu dropped=%lu\n",
+                getLevelFastDB(), getLevelSlowDB(),
+                (unsigned long)level.secondsClosed, (unsigned long)level.secondsDropped);
+#endif
+  const LoggerWriteStats sd = getLoggerWriteStats();
+  if (sd.writes > 0) {
+    Serial.printf("[SD] writes=%lu avg=%.1f KB %.2f ms max=%.1f ms | %.2f MB/s | index updates=%lu staged=%lu B\n",
+                  (unsigned long)sd.writes, sd.bytes / 1024.0 / sd.writes,
+                  sd.writeUs / 1000.0 / sd.writes, sd.maxWriteUs / 1000.0,
+                  sd.writeUs ? (double)sd.bytes / sd.writeUs : 0.0,
+                  (unsigned long)sd.indexUpdates, (unsigned long)sd.staged);
+  }
+}
+
+#if CAPTURE_MODE == CAPTURE_MODE_CONTINUOUS
+// === Continuous capture: drain DMA into the hop ring, never stop the ADC ===
+#define CAPTURE_STATS_INTERVAL_MS  10000
+
+static void runContinuousCapture() {
+  uint32_t lastAutoCheckMs = 0;
+  uint32_t lastStatsMs = millis();
+
+  startContinuousCapture();
+  for (;;) {
+    // Woken by the conversion-done ISR; the timeout only bounds housekeeping latency
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(20));
+    if (pumpSampler() > 0 && fftTaskHandle) {   // FFT task may not exist yet right after boot
+      xTaskNotifyGive(fftTaskHandle);
+    }
+
+    // WiFi/NTP blocks for seconds: pause capture around it (logged as a gap, not a drop)
+    if (isPeriodicTimeSyncDue()) {
+      stopContinuousCapture();
+      tryPeriodicTimeSync();
+      startContinuousCapture();
+    }
+
+    runBatteryAutoCheck(lastAutoCheckMs);
+
+    uint32_t nowMs = millis();
+    if (nowMs - lastStatsMs >= CAPTURE_STATS_INTERVAL_MS) {
+      lastStatsMs = nowMs;
+      CaptureStats s = getCaptureStats();
+      Serial.printf("[ADC] Continuous: captured=%llu expected=%llu (%.4f) | dropped=%llu ovf=%lu gaps=%lu | ring max=%lu/%d hops\n",
+                    s.capturedSamples, s.expectedSamples,
+                    s.expectedSamples ? (double)s.capturedSamples / (double)s.expectedSamples : 0.0,
+                    s.droppedSamples, (unsigned long)s.poolOverflows, (unsigned long)s.gaps,
+                    (unsigned long)s.maxRingHops, CAPTURE_RING_HOPS);
+      reportPipelineStats(true);
+    }
+  }
+}
+#endif
+
 void samplerTask(void*) {
   if (!initSampler(xTaskGetCurrentTaskHandle())) {
     Serial.println("[FATAL] Sampler init failed");
     vTaskDelete(nullptr);
   }
 
+#if CAPTURE_MODE == CAPTURE_MODE_CONTINUOUS
+  runContinuousCapture();
+#endif
+
   static uint32_t lastAutoCheckMs = 0;
 
   for (;;) {
@@ -204,7 +330,9 @@ void samplerTask(void*) {
     // --- Sampling timing ---
     uint32_t tS0 = millis();
     Serial.println("\n[CYCLE] Sampling started");
+    g_captureSeq++;
     beginSamplingAsync();
+    xTaskNotify(fftTaskHandle, FFT_EVT_CAPTURE_START, eSetBits);   // FFT follows the capture hop by hop
     while (!pollSampler()) {
       // Keep core responsive; don’t consume task notifications here
       vTaskDelay(pdMS_TO_TICKS(1));
@@ -212,35 +340,20 @@ void samplerTask(void*) {
     g_lastSampleMs = millis() - tS0;
     Serial.printf("[ADC] Samples: %lu | t=%lums\n", getSampleCount(), g_lastSampleMs);
 
-    // Hand off to FFT and wait for logger completion
-    xTaskNotifyGive(fftTaskHandle);
+    // Hand off the tail to FFT
+    xTaskNotify(fftTaskHandle, FFT_EVT_CAPTURE_DONE, eSetBits);
+#if PIPELINE_OVERLAP
+    // Don't wait for the logger; drop the DMA ISR's capture-time notifications
+    // so the next cycle really waits for the timer
+    ulTaskNotifyTake(pdTRUE, 0);
+#else
     ulTaskNotifyTake(pdTRUE, portMAX_DELAY);  // wait for logger done
+#endif
+    reportPipelineStats(false);
     // g_lastFFTMs and g_lastLogMs are updated in their respective tasks
 
     // === Periodic background battery check ===
-    uint32_t nowMs = millis();
-    if ((nowMs - lastAutoCheckMs) >= BATTERY_AUTOCHECK_INTERVAL_MS) {
-      lastAutoCheckMs = nowMs;  // update early to avoid drift on long checks
-
-      // Skip background check while the on-screen battery UI is active.
-      if (!isDisplayActive()) {
-        float v = 0.0f, p = 0.0f;
-        if (checkBatteryStatus(v, p)) {
-          Serial.printf("[BATMON] Auto-check: V=%.3fV, %%=%.1f\n", v, p);
-          if (isBatteryLow()) {
-            showShutdownWarning(v);
-            vTaskDelay(pdMS_TO_TICKS(2000));
-            prepareForDeepSleep();
-            esp_deep_sleep_start();
-          }
-        } else {
-          Serial.println("[BATMON] Auto-check failed (readBattery).");
-        }
-        // STEMMA power handling is internal to checkBatteryStatus()/display manager.
-      } else {
-        Serial.println("[BATMON] Skipped auto-check (UI active).");
-      }
-    }
+    runBatteryAutoCheck(lastAutoCheckMs);
 
     // --- Pad to cycle, print duty breakdown ---
     uint32_t elapsed  = millis() - cycleStart;
@@ -273,61 +386,205 @@ void samplerTask(void*) {
 
 
 // === FFT Task ===
+// Snapshot the engine's spectrum into a pool slot and queue its index for the logger
+static void publishFFTFrame(uint32_t tF0) {
+  uint8_t slot = acquireFrame();
+  if (slot == FRAME_POOL_NONE) { g_lastFFTMs = millis() - tF0; return; }
+  FFTFrame* frame = getFrame(slot);
+  frame->features = getFFTFeatures();
+  if (!frame->features.quiet) {   // quiet frames log level statistics only
+#if FFT_LOG_RECORD == FFT_LOG_SPECTRUM || FFT_LOG_RECORD == FFT_LOG_COMPACT
+    memcpy(frame->magnitudes, getFFTMagnitudes(), sizeof(float) * FFT_BINS);
+#endif
+    memcpy(frame->bandLevels, getFFTBandLevels(), sizeof(frame->bandLevels));
+  }
+  frame->timestamp = (uint64_t)time(nullptr);
+#if LEVEL_METER_ENABLED
+  frame->levelCount = drainLevelSeconds(frame->levelSeconds, LEVEL_SECONDS_PER_FRAME, frame->timestamp);
+#else
+  frame->levelCount = 0;
+#endif
+  // Statistical levels sample the Fast reading once per frame; without the
+  // meter (or while it settles) the frame's own level stands in
+#if LEVEL_METER_ENABLED
+  if (isLevelMeterSettled()) {
+    frame->levelDB = getLevelFastDB();
+  } else
+#endif
+  {
+    frame->levelDB = frame->features.quiet
+                       ? fmaxf(20.0f * log10f(frame->features.levelRMS) + LEVEL_DB_OFFSET, LEVEL_DB_FLOOR)
+                       : frame->features.laeqDB;
+  }
+  g_lastFFTMs = millis() - tF0;
+
+  pipelineSend(fftQueue, slot);   // a dropped slot goes back to the pool via onDrop
+}
+
+#if CAPTURE_MODE == CAPTURE_MODE_CONTINUOUS
+// One frame per CONTINUOUS_FRAME_HOPS hops; windows keep running across frame
+// edges because the engine's hop history is only reset on a capture gap.
+#define CONTINUOUS_FRAME_HOPS  (TOTAL_SAMPLES / FFT_STEP_SIZE)
+#endif
+
+#if CAPTURE_MODE == CAPTURE_MODE_BURST
+// Hops [hopsPushed, hopsReady) of a burst capture into the engine
+static void pushCaptureHops(const uint16_t* capture, size_t& hopsPushed, size_t hopsReady) {
+  while (hopsPushed < hopsReady) {
+    // Calibration, DC removal and windowing happen inside the FFT input stage
+    pushHop(capture + hopsPushed * FFT_STEP_SIZE, getRawToVoltsTable());
+    hopsPushed++;
+  }
+}
+
+static void finishCapture(uint32_t tF0) {
+  if (finalizeFrame()) {
+    publishFFTFrame(tF0);
+  } else {
+    g_lastFFTMs = millis() - tF0;
+  }
+}
+#endif
+
 void fftTask(void*) {
+#if FFT_PARALLEL
+  setFFTLaneWorkerCore(getTaskCore(PipelineTask::FFT_LANE));
+#endif
   if (!initFFTEngine()) {
     Serial.println("[FATAL] FFT init failed");
     vTaskDelete(nullptr);
   }
+  if (!initFramePool(getFFTFrequencies(), FFT_BINS)) {
+    Serial.println("[FATAL] Frame pool init failed");
+    vTaskDelete(nullptr);
+  }
+#if FFT_PARALLEL
+  registerPipelineTask(PipelineTask::FFT_LANE, getFFTLaneWorker());
+#endif
+#if LEVEL_METER_ENABLED
+  initLevelMeter();   // fed the engine's A-weighted window powers
+#endif
+
+#if CAPTURE_MODE == CAPTURE_MODE_CONTINUOUS
+  size_t frameHops = 0;
   for (;;) {
     ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    bool gap = false;
+    const uint16_t* hop;
+    while ((hop = peekHop(&gap)) != nullptr) {
+      uint32_t tF0 = millis();
+      if (gap) resetHopHistory();   // never window across a discontinuity
+      pushHop(hop, getRawToVoltsTable());
+      releaseHop();
+      if (++frameHops < CONTINUOUS_FRAME_HOPS) continue;
+
+      frameHops = 0;
+      const bool ok = finalizeFrame();
+#if LEVEL_METER_ENABLED
+      // The frame's windows before it is published (with the seconds they closed)
+      float windowLevels[FFT_WINDOW_LEVELS];
+      levelMeterPushWindows(windowLevels, drainFFTWindowLevels(windowLevels, FFT_WINDOW_LEVELS));
+#endif
+      if (ok) {
+        publishFFTFrame(tF0);
+      } else {
+        g_lastFFTMs = millis() - tF0;
+      }
+    }
+  }
+#else
+  // Hops are pushed while the capture is still running; only the last window
+  // and feature extraction remain once it completes (g_lastFFTMs = that tail).
+  // Events are notification bits: a late wake can hold DONE of the capture
+  // being followed and START of the next one. DONE is handled first, over the
+  // whole capture (its codes stay valid until the capture after next starts,
+  // while getSampleCount() already counts the new one).
+  const uint16_t* capture = nullptr;
+  uint32_t captureSeq = 0;
+  size_t hopsPushed = 0;
+  for (;;) {
+    uint32_t events = 0;
+    xTaskNotifyWait(0, UINT32_MAX, &events, capture ? pdMS_TO_TICKS(FFT_HOP_POLL_MS) : portMAX_DELAY);
 
-    const uint16_t* raw = getReadySamples();
-    size_t count = getSampleCount();
+    if ((events & FFT_EVT_CAPTURE_DONE) && capture) {
+      events &= ~FFT_EVT_CAPTURE_DONE;
+      if (g_captureSeq - captureSeq >= 2) {
+        g_fftOverruns++;   // buffer already refilled by the capture after next
+      } else {
+        uint32_t tF0 = millis();
+        pushCaptureHops(capture, hopsPushed, TOTAL_SAMPLES / FFT_STEP_SIZE);
+        finishCapture(tF0);
+      }
+      capture = nullptr;
+    }
+    if (events & FFT_EVT_CAPTURE_START) {
+      const uint32_t seq = g_captureSeq;
+      if (capture) g_fftOverruns++;                                  // DONE never seen
+      if (seq - captureSeq > 1) g_fftOverruns += seq - captureSeq - 1;   // STARTs merged
+      capture = getCaptureBuffer();
+      captureSeq = seq;
+      hopsPushed = 0;
+      beginFrame();
+    }
+    if (!capture) continue;
 
     uint32_t tF0 = millis();
+    pushCaptureHops(capture, hopsPushed, getSampleCount() / FFT_STEP_SIZE);
 
-    float* volts = (float*)heap_caps_malloc(sizeof(float) * count, MALLOC_CAP_SPIRAM);
-    if (!volts || !convertRawToMV(raw, volts, count)) {
-      if (volts) free(volts);
-      g_lastFFTMs = millis() - tF0;
-      continue;
+    if (events & FFT_EVT_CAPTURE_DONE) {   // started and finished within this wake
+      capture = nullptr;
+      finishCapture(tF0);
     }
+  }
+#endif
+}
 
-    if (processFFT(volts, count)) {
-      FFTFrame* frame = (FFTFrame*)heap_caps_malloc(sizeof(FFTFrame), MALLOC_CAP_SPIRAM);
-      if (!frame) { free(volts); g_lastFFTMs = millis() - tF0; continue; }
-      frame->frequencies = (float*)heap_caps_malloc(sizeof(float) * FFT_BINS, MALLOC_CAP_SPIRAM);
-      frame->magnitudes  = (float*)heap_caps_malloc(sizeof(float) * FFT_BINS, MALLOC_CAP_SPIRAM);
-      frame->count = FFT_BINS;
-      if (!frame->frequencies || !frame->magnitudes) {
-        if (frame->frequencies) free(frame->frequencies);
-        if (frame->magnitudes)  free(frame->magnitudes);
-        free(frame);
-        free(volts);
-        g_lastFFTMs = millis() - tF0;
-        continue;
-      }
-      memcpy(frame->frequencies, getFFTFrequencies(), sizeof(float) * FFT_BINS);
-      memcpy(frame->magnitudes,  getFFTMagnitudes(), sizeof(float) * FFT_BINS);
-      free(volts);
-      g_lastFFTMs = millis() - tF0;
-
-      if (xQueueSend(fftQueue, &frame, pdMS_TO_TICKS(10)) != pdPASS) {
-        free(frame->frequencies);
-        free(frame->magnitudes);
-        free(frame);
-      }
-    } else {
-      free(volts);
-      g_lastFFTMs = millis() - tF0;
+// === Logger Task ===
+// One record per frame, of the type FFT_LOG_RECORD selects, then the
+// level-meter seconds that travelled with it
+static bool saveFrame(const FFTFrame* frame) {
+#if FFT_LOG_RECORD == FFT_LOG_BANDS
+  bool ok = saveBandFrame(frame->bandLevels, THIRD_OCTAVE_BANDS, frame->features, frame->timestamp);
+#elif FFT_LOG_RECORD == FFT_LOG_COMPACT
+  bool ok = saveCompactFrame(frame->magnitudes, frame->count, frame->features, frame->timestamp);
+#else
+  bool ok = saveFFTFrame(frame->frequencies, frame->magnitudes, frame->count,
+                         frame->features, frame->timestamp);
+#endif
+  if (ok && frame->levelCount > 0) ok = saveLevelSeconds(frame->levelSeconds, frame->levelCount);
+  return ok;
+}
+
+// Feed every frame to the L10/L50/L90 histograms and the minute summary,
+// whether or not it was saved, and log the periods it closes
+static void updateSummaries(const FFTFrame* frame) {
+#if LEVEL_STATS_ENABLED
+  LevelSummary closed[2];
+  const size_t n = levelStatsPush(frame->levelDB, frame->timestamp, closed);
+  for (size_t i = 0; i < n; ++i) {
+    if (isLoggerReady() && !saveLevelSummary(closed[i])) {
+      Serial.println("[LOGGER] Level summary not saved");
     }
   }
+#endif
+#if MINUTE_SUMMARY_ENABLED
+  MinuteSummary minute;
+  if (minuteSummaryPush(frame->features, frame->timestamp, &minute) &&
+      isLoggerReady() && !saveMinuteSummary(minute)) {
+    Serial.println("[LOGGER] Minute summary not saved");
+  }
+#endif
 }
 
-// === Logger Task ===
 void loggerTask(void*) {
-  FFTFrame* frame = nullptr;
+  uint8_t slot = FRAME_POOL_NONE;
   uint32_t lastRetryMs = 0;
+#if LEVEL_STATS_ENABLED
+  initLevelStats();
+#endif
+#if MINUTE_SUMMARY_ENABLED
+  initMinuteSummary();
+#endif
 
   for (;;) {
     // If SD not ready, try to init every ~500 ms
@@ -342,12 +599,20 @@ void loggerTask(void*) {
       }
     }
 
-    if (xQueueReceive(fftQueue, &frame, portMAX_DELAY) == pdTRUE && frame) {
+    // Idle: push staged records out once they are LOG_FLUSH_AGE_MS old
+    if (!pipelineReceive(fftQueue, &slot, pdMS_TO_TICKS(LOG_FLUSH_AGE_MS))) {
+      if (isLoggerReady() && !flushFFTLogger(false)) {
+        Serial.println("[LOGGER] Staged records not flushed");
+      }
+      continue;
+    }
+    if (getFrame(slot)) {
+      const FFTFrame* frame = getFrame(slot);
       uint32_t tL0 = millis();
       bool ok = false;
 
       if (isLoggerReady()) {
-        ok = saveFFTFrame(frame->frequencies, frame->magnitudes, frame->count);
+        ok = saveFrame(frame);
 
         if (!ok) {
           Serial.println("[LOGGER] Save failed, attempting clean reinit...");
@@ -355,7 +620,7 @@ void loggerTask(void*) {
           vTaskDelay(pdMS_TO_TICKS(200));
           if (initFFTLogger()) {
             tL0 = millis();
-            ok = saveFFTFrame(frame->frequencies, frame->magnitudes, frame->count);
+            ok = saveFrame(frame);
           }
         }
       } else {
@@ -363,14 +628,15 @@ void loggerTask(void*) {
       }
 
       g_lastLogMs = millis() - tL0;
+      updateSummaries(frame);
 
-      // Free frame regardless to avoid leaks
-      free(frame->frequencies);
-      free(frame->magnitudes);
-      free(frame);
+      // Return the slot regardless of the outcome
+      releaseFrame(slot);
 
+#if CAPTURE_MODE == CAPTURE_MODE_BURST && !PIPELINE_OVERLAP
       // Notify sampler so the cycle continues
       xTaskNotifyGive(samplerTaskHandle);
+#endif
     }
   }
 }
@@ -439,8 +705,8 @@ void setup() {
   displayTimer = xTimerCreate("DispOff", pdMS_TO_TICKS(2000), pdFALSE, NULL, turnOffDisplayCallback);
   cycleTimer   = xTimerCreate("Cycle",   pdMS_TO_TICKS(CYCLE_PERIOD_MS), pdTRUE,  NULL, onCycleTimer);
 
-  fftQueue = xQueueCreate(FFT_QUEUE_LENGTH, sizeof(FFTFrame*));
-  if (!fftQueue) {
+  if (!initPipelineQueue(fftQueue, "fft→log", FFT_QUEUE_LENGTH, FFT_QUEUE_POLICY,
+                         pdMS_TO_TICKS(FFT_QUEUE_BLOCK_MS), releaseFrame)) {
     Serial.println("[FATAL] FFT queue creation failed");
     while (true) { vTaskDelay(pdMS_TO_TICKS(1000)); }
   }
@@ -452,13 +718,32 @@ void setup() {
   Serial.printf("[TIME] Ready at boot: %s\n", getFormattedTime().c_str());
 
   // ====== Start tasks and timer after time is valid ======
-  xTaskCreatePinnedToCore(samplerTask, "Sampler", 4096, NULL, 3, &samplerTaskHandle, 0);
-  xTaskCreatePinnedToCore(fftTask,     "FFT",     4096, NULL, 2, &fftTaskHandle,    0);
-  xTaskCreatePinnedToCore(loggerTask,  "Logger",  4096, NULL, 1, &loggerTaskHandle, 0);
-  xTaskCreatePinnedToCore(batteryTask, "Battery", 4096, NULL, 1, &batteryTaskHandle,0);
+  // Core per task from task_placement (compile-time defaults, NVS overrides)
+  struct TaskSpec {
+    TaskFunction_t fn;
+    const char* name;
+    uint32_t stack;
+    UBaseType_t priority;
+    PipelineTask id;
+    TaskHandle_t* handle;
+  };
+  static const TaskSpec taskSpecs[] = {
+    { samplerTask, "Sampler", 4096, 3, PipelineTask::SAMPLER, &samplerTaskHandle },
+    { fftTask,     "FFT",     4096, 2, PipelineTask::FFT,     &fftTaskHandle     },
+    { loggerTask,  "Logger",  4096, 1, PipelineTask::LOGGER,  &loggerTaskHandle  },
+    { batteryTask, "Battery", 4096, 1, PipelineTask::BATTERY, &batteryTaskHandle },
+  };
+  loadTaskPlacement();
+  printTaskPlacement();
+  for (const TaskSpec& t : taskSpecs) {
+    xTaskCreatePinnedToCore(t.fn, t.name, t.stack, NULL, t.priority, t.handle, getTaskCore(t.id));
+    registerPipelineTask(t.id, *t.handle);
+  }
   setBatteryTaskHandle(batteryTaskHandle);
 
-  xTimerStart(cycleTimer, 0);
+#if CAPTURE_MODE == CAPTURE_MODE_BURST
+  xTimerStart(cycleTimer, 0);   // continuous mode is paced by the ADC itself
+#endif
 
   Serial.printf("[MEM] Heap: %u | PSRAM: %u\n",
                 heap_caps_get_free_size(MALLOC_CAP_INTERNAL),
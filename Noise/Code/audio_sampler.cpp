@@ -14,6 +14,7 @@
 #include "esp_adc/adc_cali_scheme.h"
 #include "esp_heap_caps.h"
 #include "esp_adc/adc_filter.h"
+#include "esp_timer.h"
 
 static adc_continuous_handle_t adc_handle = nullptr;
 static adc_cali_handle_t adc_cali_handle = nullptr;
@@ -23,6 +24,7 @@ static uint16_t* bufferA = nullptr;
 static uint16_t* bufferB = nullptr;
 static uint16_t* activeBuffer = nullptr;
 static uint16_t* readyBuffer = nullptr;
+static uint16_t* captureBuffer = nullptr;   // buffer of the current/last capture (survives the swap)
 
 static volatile uint32_t sampleIndex = 0;
 static TaskHandle_t notifyTask = nullptr;
@@ -30,6 +32,9 @@ static TaskHandle_t notifyTask = nullptr;
 static uint8_t* wavBuffer = nullptr;    // Single pre-allocation for WAV output  (Change #2)
 static uint32_t wavBufferSize = 0;
 
+static float* rawToVolts = nullptr;     // ADC code → calibrated volts, built once from the cali scheme
+static int16_t* rawToMV = nullptr;      // ADC code → calibrated mV (exact adc_cali_raw_to_voltage() output)
+
 enum class SamplerState {
   IDLE,
   INIT,
@@ -42,6 +47,21 @@ static bool samplingComplete = false;
 
 static SamplerStatus samplerStatus = SamplerStatus::NOT_INITIALIZED;
 
+// === Continuous capture ring ===
+// Slot = hop counter % CAPTURE_RING_HOPS. Counters only ever grow; the writer
+// publishes hopsWritten with release, the reader publishes hopsRead the same way.
+static uint16_t* ring = nullptr;
+static uint8_t ringGap[CAPTURE_RING_HOPS];   // hop follows discarded samples
+static uint32_t hopsWritten = 0;
+static uint32_t hopsRead = 0;
+static uint32_t hopFill = 0;                 // codes already in the hop being written
+static bool discarding = false;              // ring full, dropping until a slot frees
+static bool continuousRunning = false;
+static uint64_t runStartUs = 0;
+static uint64_t runAccumUs = 0;              // completed start/stop spans
+static CaptureStats captureStats = {};
+static volatile uint32_t poolOverflows = 0;
+
 static bool IRAM_ATTR on_conversion_done(adc_continuous_handle_t,
                                          const adc_continuous_evt_data_t*,
                                          void*) {
@@ -52,6 +72,13 @@ static bool IRAM_ATTR on_conversion_done(adc_continuous_handle_t,
   return mustYield == pdTRUE;
 }
 
+static bool IRAM_ATTR on_pool_overflow(adc_continuous_handle_t,
+                                       const adc_continuous_evt_data_t*,
+                                       void*) {
+  poolOverflows = poolOverflows + 1;   // driver dropped conversions: reader too slow
+  return false;
+}
+
 bool initSampler(TaskHandle_t ownerTask) {
   notifyTask = ownerTask;
   sampleIndex = 0;
@@ -101,7 +128,8 @@ bool initSampler(TaskHandle_t ownerTask) {
   ESP_ERROR_CHECK(adc_continuous_config(adc_handle, &dig_cfg));
 
   adc_continuous_evt_cbs_t cbs = {
-    .on_conv_done = on_conversion_done
+    .on_conv_done = on_conversion_done,
+    .on_pool_ovf = on_pool_overflow
   };
   ESP_ERROR_CHECK(adc_continuous_register_event_callbacks(adc_handle, &cbs, nullptr));
 
@@ -128,6 +156,36 @@ bool initSampler(TaskHandle_t ownerTask) {
     return false;
   }
 
+  // Tabulate the curve once: 4096 driver calls here instead of one per sample per cycle.
+  // Internal RAM first — every conversion is a random gather into these tables.
+  rawToVolts = (float*)heap_caps_malloc(ADC_RAW_CODES * sizeof(float), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+  if (!rawToVolts) rawToVolts = (float*)heap_caps_malloc(ADC_RAW_CODES * sizeof(float), MALLOC_CAP_SPIRAM);
+  rawToMV = (int16_t*)heap_caps_malloc(ADC_RAW_CODES * sizeof(int16_t), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+  if (!rawToMV) rawToMV = (int16_t*)heap_caps_malloc(ADC_RAW_CODES * sizeof(int16_t), MALLOC_CAP_SPIRAM);
+  if (!rawToVolts || !rawToMV) {
+    Serial.println("[ADC] Calibration table allocation failed");
+    samplerStatus = SamplerStatus::ALLOC_FAILED;
+    return false;
+  }
+  for (int code = 0; code < ADC_RAW_CODES; ++code) {
+    int mv = 0;
+    adc_cali_raw_to_voltage(adc_cali_handle, code, &mv);
+    rawToMV[code] = (int16_t)mv;
+    rawToVolts[code] = (float)mv / MV_TO_V_SCALE;
+  }
+  Serial.printf("[ADC] Calibration table: code 0 → %d mV, code %d → %d mV\n",
+                rawToMV[0], ADC_RAW_CODES - 1, rawToMV[ADC_RAW_CODES - 1]);
+
+#if CAPTURE_MODE == CAPTURE_MODE_CONTINUOUS
+  ring = (uint16_t*)heap_caps_malloc(CAPTURE_RING_HOPS * FFT_STEP_SIZE * sizeof(uint16_t), MALLOC_CAP_SPIRAM);
+  if (!ring) {
+    Serial.println("[ADC] PSRAM ring allocation failed");
+    samplerStatus = SamplerStatus::ALLOC_FAILED;
+    return false;
+  }
+  Serial.printf("[ADC] Ring: %d hops × %d codes (%p)\n", CAPTURE_RING_HOPS, FFT_STEP_SIZE, ring);
+#endif
+
   samplerStatus = SamplerStatus::OK;
   return true;
 }
@@ -144,6 +202,9 @@ bool resetSampler() {   // Change #4: Soft reset without reallocation
 }
 
 void beginSamplingAsync() {
+  // Set synchronously so a consumer following the capture never sees the previous one
+  sampleIndex = 0;
+  captureBuffer = activeBuffer;
   samplerState = SamplerState::INIT;
   samplingComplete = false;
 }
@@ -202,21 +263,48 @@ bool pollSampler() {
 bool isSamplingDone() { return samplingComplete; }
 bool isSamplerActive() { return samplerState == SamplerState::SAMPLING; }
 const uint16_t* getReadySamples() { return readyBuffer; }
+const uint16_t* getCaptureBuffer() { return captureBuffer; }
 uint32_t getSampleCount() { return sampleIndex; }
 SamplerStatus getSamplerStatus() { return samplerStatus; }
+const float* getRawToVoltsTable() { return rawToVolts; }
+const int16_t* getRawToMVTable() { return rawToMV; }
 
-bool convertRawToMV(const uint16_t* raw, float* out_mv, size_t count) {
-  if (!adc_cali_handle || !raw || !out_mv) return false;
-  for (size_t i = 0; i < count; ++i) {
-    int mv = 0;
-    adc_cali_raw_to_voltage(adc_cali_handle, raw[i], &mv);
-    out_mv[i] = mv;
+int getSampleVoltage(uint32_t index) {
+  if (!readyBuffer || !rawToMV || index >= sampleIndex) return 0;
+  return rawToMV[readyBuffer[index] & (ADC_RAW_CODES - 1)];
+}
+
+// Table gather, 4 lanes per iteration: independent loads keep the LX7 pipeline
+// busy (PIE has no gather, so this is as wide as the lookup gets on-chip).
+template <typename T>
+static void gatherCalibrated(const uint16_t* raw, const T* table, float* out, size_t count) {
+  const uint16_t mask = ADC_RAW_CODES - 1;
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    const uint16_t c0 = raw[i] & mask, c1 = raw[i + 1] & mask;
+    const uint16_t c2 = raw[i + 2] & mask, c3 = raw[i + 3] & mask;
+    out[i]     = (float)table[c0];
+    out[i + 1] = (float)table[c1];
+    out[i + 2] = (float)table[c2];
+    out[i + 3] = (float)table[c3];
   }
+  for (; i < count; ++i) out[i] = (float)table[raw[i] & mask];
+}
+
+bool convertRawToMV(const uint16_t* raw, float* out_mv, size_t count) {
+  if (!rawToMV || !raw || !out_mv) return false;
+  gatherCalibrated(raw, rawToMV, out_mv, count);
+  return true;
+}
+
+bool convertRawToVolts(const uint16_t* raw, float* out_v, size_t count) {
+  if (!rawToVolts || !raw || !out_v) return false;
+  gatherCalibrated(raw, rawToVolts, out_v, count);
   return true;
 }
 
 const uint8_t* getLastWAV(uint32_t* outSize) {
-  if (!readyBuffer || !adc_cali_handle) return nullptr;
+  if (!readyBuffer || !rawToVolts) return nullptr;
 
   uint32_t numSamples = getSampleCount();
   uint32_t dataSize = numSamples * sizeof(int16_t);
@@ -244,46 +332,148 @@ const uint8_t* getLastWAV(uint32_t* outSize) {
   memcpy(ptr, "data", 4); ptr += 4;
   memcpy(ptr, &dataSize, 4); ptr += 4;
 
-  float* volts = (float*)heap_caps_malloc(numSamples * sizeof(float), MALLOC_CAP_SPIRAM);
-  if (!volts) return nullptr;
-
-  convertRawToMV(readyBuffer, volts, numSamples);
-
+  // Straight from raw codes through the table: no volts scratch buffer.
+  // Mean and extremes in one pass; peak |x - mean| follows from min/max.
+  const uint16_t mask = ADC_RAW_CODES - 1;
   float mean = 0;
+  float vmin = 0.0f, vmax = 0.0f;
   for (uint32_t i = 0; i < numSamples; ++i) {
-    volts[i] /= 1000.0f;
-    mean += volts[i];
+    float v = rawToVolts[readyBuffer[i] & mask];
+    mean += v;
+    if (i == 0 || v < vmin) vmin = v;
+    if (i == 0 || v > vmax) vmax = v;
   }
-  mean /= numSamples;
+  if (numSamples > 0) mean /= numSamples;
 
   int16_t* pcm = (int16_t*)ptr;
-  float peak = 0.0f;
-  for (uint32_t i = 0; i < numSamples; ++i) {
-    float centered = volts[i] - mean;
-    if (fabs(centered) > peak) peak = fabs(centered);
-  }
+  float peak = std::max(vmax - mean, mean - vmin);
   float gain = (peak > 0) ? (0.95f / peak) : 1.0f; // Change #5: dynamic gain
 
   for (uint32_t i = 0; i < numSamples; ++i) {
-    float centered = (volts[i] - mean) * gain;
+    float centered = (rawToVolts[readyBuffer[i] & mask] - mean) * gain;
     centered = std::clamp(centered, -1.0f, 1.0f);
     pcm[i] = (int16_t)(centered * 32767.0f);
   }
 
-  free(volts);
   if (outSize) *outSize = 44 + dataSize;
   return wavBuffer;
 }
 
+// === Continuous capture ===
+bool startContinuousCapture() {
+  if (!adc_handle || !ring || continuousRunning) return false;
+  // A restart abandons the partial hop; the next complete one carries a gap flag
+  if (hopsWritten > 0 || hopFill > 0) {
+    captureStats.gaps++;
+    discarding = true;
+  }
+  hopFill = 0;
+  runStartUs = esp_timer_get_time();
+  ESP_ERROR_CHECK(adc_continuous_start(adc_handle));
+  continuousRunning = true;
+  Serial.println("[ADC] Continuous capture started");
+  return true;
+}
+
+void stopContinuousCapture() {
+  if (!continuousRunning) return;
+  ESP_ERROR_CHECK(adc_continuous_stop(adc_handle));
+  runAccumUs += esp_timer_get_time() - runStartUs;
+  continuousRunning = false;
+}
+
+uint32_t pumpSampler() {
+  if (!continuousRunning) return 0;
+
+  static uint8_t dmaBuf[1024];
+  uint32_t bytesRead = 0;
+  uint32_t completed = 0;
+
+  // Non-blocking drain: everything the driver pool holds right now
+  while (adc_continuous_read(adc_handle, dmaBuf, sizeof(dmaBuf), &bytesRead, 0) == ESP_OK) {
+    auto* data = (adc_digi_output_data_t*)dmaBuf;
+    uint32_t count = bytesRead / sizeof(adc_digi_output_data_t);
+    captureStats.capturedSamples += count;
+
+    uint32_t i = 0;
+    while (i < count) {
+      if (hopFill == 0) {
+        uint32_t inUse = hopsWritten - __atomic_load_n(&hopsRead, __ATOMIC_ACQUIRE);
+        if (inUse >= CAPTURE_RING_HOPS) {
+          // Reader is a full ring behind: drop the rest of this chunk
+          if (!discarding) captureStats.gaps++;
+          discarding = true;
+          captureStats.droppedSamples += count - i;
+          break;
+        }
+        ringGap[hopsWritten % CAPTURE_RING_HOPS] = discarding ? 1 : 0;
+        discarding = false;
+      }
+
+      uint16_t* dst = ring + (size_t)(hopsWritten % CAPTURE_RING_HOPS) * FFT_STEP_SIZE + hopFill;
+      uint32_t n = std::min<uint32_t>(count - i, FFT_STEP_SIZE - hopFill);
+      for (uint32_t j = 0; j < n; ++j) dst[j] = data[i + j].type2.data;
+      hopFill += n;
+      i += n;
+
+      if (hopFill == FFT_STEP_SIZE) {
+        hopFill = 0;
+        __atomic_store_n(&hopsWritten, hopsWritten + 1, __ATOMIC_RELEASE);
+        completed++;
+        uint32_t inUse = hopsWritten - __atomic_load_n(&hopsRead, __ATOMIC_ACQUIRE);
+        if (inUse > captureStats.maxRingHops) captureStats.maxRingHops = inUse;
+      }
+    }
+  }
+  captureStats.hopsWritten = hopsWritten;
+  return completed;
+}
+
+uint32_t getAvailableHops() {
+  return __atomic_load_n(&hopsWritten, __ATOMIC_ACQUIRE) - hopsRead;
+}
+
+const uint16_t* peekHop(bool* gapBefore) {
+  if (!ring || getAvailableHops() == 0) return nullptr;
+  size_t slot = hopsRead % CAPTURE_RING_HOPS;
+  if (gapBefore) *gapBefore = ringGap[slot] != 0;
+  return ring + slot * FFT_STEP_SIZE;
+}
+
+void releaseHop() {
+  if (getAvailableHops() == 0) return;
+  __atomic_store_n(&hopsRead, hopsRead + 1, __ATOMIC_RELEASE);
+}
+
+CaptureStats getCaptureStats() {
+  CaptureStats s = captureStats;
+  uint64_t runUs = runAccumUs + (continuousRunning ? esp_timer_get_time() - runStartUs : 0);
+  s.expectedSamples = runUs * SAMPLE_RATE / 1000000ULL;
+  s.poolOverflows = poolOverflows;
+  return s;
+}
+
 void deinitSampler() {
+  stopContinuousCapture();
   if (adc_handle) { adc_continuous_deinit(adc_handle); adc_handle = nullptr; }
   if (iir_filter) { adc_continuous_iir_filter_disable(iir_filter); adc_del_continuous_iir_filter(iir_filter); iir_filter = nullptr; }
   if (adc_cali_handle) { adc_cali_delete_scheme_curve_fitting(adc_cali_handle); adc_cali_handle = nullptr; }
   if (bufferA) free(bufferA);
   if (bufferB) free(bufferB);
   if (wavBuffer) free(wavBuffer);
-  bufferA = bufferB = activeBuffer = readyBuffer = nullptr;
+  if (rawToVolts) free(rawToVolts);
+  if (rawToMV) free(rawToMV);
+  if (ring) free(ring);
+  ring = nullptr;
+  hopsWritten = hopsRead = hopFill = 0;
+  discarding = false;
+  captureStats = CaptureStats{};
+  poolOverflows = 0;
+  runAccumUs = 0;
+  bufferA = bufferB = activeBuffer = readyBuffer = captureBuffer = nullptr;
   wavBuffer = nullptr;
+  rawToVolts = nullptr;
+  rawToMV = nullptr;
   notifyTask = nullptr;
   sampleIndex = 0;
   samplerState = SamplerState::IDLE;
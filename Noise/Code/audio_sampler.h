@@ -30,6 +30,9 @@ bool isSamplerActive();
 
 // === Sample access ===
 const uint16_t* getReadySamples();              
+// Buffer being filled since beginSamplingAsync(); codes below getSampleCount() are final
+// and stay valid until the capture after next (double buffering)
+const uint16_t* getCaptureBuffer();
 uint16_t getRawSample(uint32_t index);          
 int getSampleVoltage(uint32_t index);           
 uint32_t getSampleCount();                      
@@ -37,8 +40,37 @@ uint32_t getSampleCount();
 // === WAV output ===
 const uint8_t* getLastWAV(uint32_t* outSize);   
 
-// === Optional conversion helper ===
+// === Optional conversion helpers (table gather, no per-sample calibration calls) ===
 bool convertRawToMV(const uint16_t* raw, float* out_mv, size_t count);  
+bool convertRawToVolts(const uint16_t* raw, float* out_v, size_t count);
+
+// === Calibration tables (ADC_RAW_CODES entries, built once in initSampler(); nullptr before) ===
+const float* getRawToVoltsTable();              // code → volts (FFT input stage)
+const int16_t* getRawToMVTable();               // code → mV, as adc_cali_raw_to_voltage() reports
 
 // === Status query ===
 SamplerStatus getSamplerStatus();
+
+// === Continuous capture (CAPTURE_MODE_CONTINUOUS) ===
+// The ADC free-runs into a ring of CAPTURE_RING_HOPS hops of FFT_STEP_SIZE codes.
+// One writer (pumpSampler(), sampler task) and one reader (peekHop()/releaseHop()).
+bool startContinuousCapture();                  // Start (or resume) the free-running ADC
+void stopContinuousCapture();                   // Stop ADC; unread hops stay readable, resume = gap
+uint32_t pumpSampler();                         // Drain DMA into the ring; returns hops completed
+uint32_t getAvailableHops();
+const uint16_t* peekHop(bool* gapBefore);       // Oldest unread hop, nullptr if none
+void releaseHop();                              // Hand the peeked slot back to the writer
+
+// === Capture instrumentation ===
+// expected vs captured proves coverage: with droppedSamples == 0 and poolOverflows == 0,
+// captured/expected differs from 1 only by the ADC's actual-vs-nominal clock ratio.
+struct CaptureStats {
+  uint64_t expectedSamples;   // SAMPLE_RATE × time the ADC has been running
+  uint64_t capturedSamples;   // conversions read out of the driver pool
+  uint64_t droppedSamples;    // discarded because the ring was full
+  uint32_t poolOverflows;     // driver pool overflow events (conversions lost before read)
+  uint32_t gaps;              // discontinuities handed to the reader
+  uint32_t hopsWritten;
+  uint32_t maxRingHops;       // ring high-water mark
+};
+CaptureStats getCaptureStats();
@@ -1,14 +1,32 @@
 #include "fft_engine.h"
-#include "arduinoFFT.h"
 #include "signal_config.h"
+#if FFT_BACKEND == FFT_BACKEND_ARDUINOFFT
+#include "arduinoFFT.h"
+#else
+#include "real_fft.h"
+#endif
 #include <math.h>
 #include <string.h>
 #include <algorithm>
 #include "esp_heap_caps.h"
 
+#if FFT_ENGINE_PROFILE
+#ifndef FFT_PROFILE_NOW_NS
+#include "esp_timer.h"
+#define FFT_PROFILE_NOW_NS() ((uint64_t)esp_timer_get_time() * 1000ULL)
+#endif
+#define PROF_MARK(t)                 uint64_t t = FFT_PROFILE_NOW_NS()
+#define PROF_LAP_TO(acc, field, t)   do { uint64_t _n = FFT_PROFILE_NOW_NS(); (acc).field += _n - (t); (t) = _n; } while (0)
+#define PROF_COUNT_TO(acc, field)    ((acc).field++)
+#else
+#define PROF_MARK(t)                 do {} while (0)
+#define PROF_LAP_TO(acc, field, t)   do {} while (0)
+#define PROF_COUNT_TO(acc, field)    do {} while (0)
+#endif
+#define PROF_LAP(field, t)           PROF_LAP_TO(stageTimes, field, t)
+#define PROF_COUNT(field)            PROF_COUNT_TO(stageTimes, field)
+
 // === Config (existing) ===
-#define VOICE_MIN_HZ 100
-#define VOICE_MAX_HZ 4000
 #define SNR_THRESHOLD 1.6f
 #define DELTA_E_THRESHOLD 10.0f
 #define PEAK_COUNT_THRESHOLD 3
@@ -21,72 +39,161 @@
 #define BASELINE_ALPHA        0.05f    // EMA speed for baseline when no voice
 #define EPS                   1e-9f
 
-// === Internal Buffers in PSRAM ===
-static float* vReal = nullptr;
-static float* vImag = nullptr;
-static float* magnitudes = nullptr;
-static float* frequencies = nullptr;
-
-static ArduinoFFT<float>* FFT = nullptr;
-
-// === Voice Detection State (existing) ===
-static volatile bool fftReady = false;
-static FFTStatus fftStatus = FFTStatus::NOT_READY;
-
-static size_t minVoiceBin = 0;
-static size_t maxVoiceBin = 0;
-
-static bool voiceDetected = false;
-static float voiceEnergy = 0.0f;
-static float noiseEnergy = 0.0f;
-static float snr = 0.0f;           // exported SNR (now RMS-based, more stable)
-static int   peakCount = 0;
-static float contrast = 0.0f;
-static float prevVoiceEnergy = 0.0f;
-
-// === New internal features (no API break) ===
-static float sfm = 1.0f;               // spectral flatness in voice band
-static float bandRMS = 0.0f;           // RMS magnitude in voice band
-static float noiseRMS = 0.0f;          // RMS magnitude outside band
-static float baselineBandRMS = 0.0f;   // EMA baseline of bandRMS (updated when no-voice)
-static float voiceIntensityDB = 0.0f;  // dB above baseline
-static uint8_t confirmCnt = 0;         // 2-frame confirmation
-static bool voiceState = false;        // debounced presence
-
-bool initFFTEngine() {
+// === Quiet gate (FFT_QUIET_GATE) ===
+#define QUIET_FLOOR_MARGIN    1.41f    // gate windows below floor +3 dB
+#define QUIET_MAX_RMS_V       0.010f   // never gate louder windows, whatever the floor
+#define QUIET_TRACK_CEIL      4.0f     // windows > floor +12 dB leave the floor alone
+#define QUIET_FLOOR_DOWN      0.25f    // EMA speed towards quieter windows
+#define QUIET_FLOOR_UP        0.01f    // EMA speed towards louder windows
+#define QUIET_WARMUP_WINDOWS  64       // windows measured before the first gate
+
+const char* fftPoolPolicyName(uint8_t policy) {
+  switch (policy) {
+    case FFT_POOL_MIXED:     return "mixed (band max / mean)";
+    case FFT_POOL_MAX:       return "max";
+    case FFT_POOL_MEAN_MAG:  return "mean magnitude";
+    case FFT_POOL_WELCH_PSD: return "Welch PSD";
+    case FFT_POOL_MEDIAN:    return "median";
+    default:                 return "unknown";
+  }
+}
+
+// IEC 61672 A-weighting as a power gain (0 dB at 1 kHz)
+static double aWeightingPower(double f) {
+  const double f2 = f * f;
+  const double c1 = 20.598997 * 20.598997, c2 = 107.65265 * 107.65265;
+  const double c3 = 737.86223 * 737.86223, c4 = 12194.217 * 12194.217;
+  const double ra = c4 * f2 * f2 / ((f2 + c1) * sqrt((f2 + c2) * (f2 + c3)) * (f2 + c4));
+  return ra * ra * 1.5848932;   // +2.00 dB
+}
+
+template <class Spec>
+FFTEngineT<Spec>::~FFTEngineT() { deinit(); }
+
+template <class Spec>
+bool FFTEngineT<Spec>::init() {
+  constexpr size_t n = Spec::size;
+
   // Allocate all buffers in PSRAM, free on failure
-  vReal       = (float*)heap_caps_malloc(sizeof(float) * FFT_SIZE, MALLOC_CAP_SPIRAM);
-  vImag       = (float*)heap_caps_malloc(sizeof(float) * FFT_SIZE, MALLOC_CAP_SPIRAM);
-  magnitudes  = (float*)heap_caps_malloc(sizeof(float) * FFT_BINS, MALLOC_CAP_SPIRAM);
-  frequencies = (float*)heap_caps_malloc(sizeof(float) * FFT_BINS, MALLOC_CAP_SPIRAM);
+  magnitudes  = (float*)heap_caps_malloc(sizeof(float) * bins, MALLOC_CAP_SPIRAM);
+  bool lanesOK = true;
+  for (Lane& lane : lanes) {
+    lane = Lane{};
+    lane.vReal = (float*)heap_caps_malloc(sizeof(float) * n, MALLOC_CAP_SPIRAM);
+    lane.pool  = (float*)heap_caps_malloc(sizeof(float) * POOL_FLOATS, MALLOC_CAP_SPIRAM);
+    lanesOK = lanesOK && lane.vReal && lane.pool;
+  }
 
-  if (!vReal || !vImag || !magnitudes || !frequencies) {
+  if (!magnitudes || !lanesOK) {
     Serial.println("[FFT] Failed to allocate FFT buffers");
-    deinitFFTEngine();
+    deinit();
     return false;
   }
 
-  FFT = new ArduinoFFT<float>(vReal, vImag, (float)FFT_SIZE, (float)SAMPLE_RATE);
-  if (!FFT) {
-    Serial.println("[FFT] Failed to instantiate FFT object");
-    deinitFFTEngine();
+  // Window computed once here instead of per window; hot, so internal RAM first
+  window = (float*)heap_caps_malloc(sizeof(float) * n, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+  if (!window) window = (float*)heap_caps_malloc(sizeof(float) * n, MALLOC_CAP_SPIRAM);
+#if FFT_QUIET_GATE
+  // A frame's worth of hops: PSRAM, internal RAM only as a fallback
+  staged = (float*)heap_caps_malloc(sizeof(float) * stageSlots * Spec::step, MALLOC_CAP_SPIRAM);
+  if (!staged) staged = (float*)heap_caps_malloc(sizeof(float) * stageSlots * Spec::step, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+#else
+  staged = (float*)heap_caps_malloc(sizeof(float) * n, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+  if (!staged) staged = (float*)heap_caps_malloc(sizeof(float) * n, MALLOC_CAP_SPIRAM);
+#endif
+  if (!window || !staged) {
+    Serial.println("[FFT] Failed to allocate FFT buffers");
+    deinit();
     return false;
   }
 
-  for (size_t i = 0; i < FFT_BINS; ++i) {
-    frequencies[i] = ((float)i * SAMPLE_RATE) / FFT_SIZE;
+  // Same Hamming definition as ArduinoFFT::windowing() (denominator N-1)
+  double windowPower = 0.0;
+  for (size_t i = 0; i < n; ++i) {
+    double ratio = (double)i / (double)(n - 1);
+    window[i] = (float)(0.54 - 0.46 * cos(2.0 * M_PI * ratio));
+    windowPower += (double)window[i] * window[i];
   }
+  psdScale = (float)(1.0 / ((double)Spec::sampleRate * windowPower));
 
-  minVoiceBin = (size_t)((VOICE_MIN_HZ * FFT_SIZE) / SAMPLE_RATE);
-  maxVoiceBin = (size_t)((VOICE_MAX_HZ * FFT_SIZE) / SAMPLE_RATE);
-  if (maxVoiceBin >= FFT_BINS) maxVoiceBin = FFT_BINS - 1;
+  // Band tables: A-weighting per bin (internal RAM first, read every frame)
+  // and the bin range of each 1/3-octave band (bins centred in [lo, hi))
+  aWeight = (float*)heap_caps_malloc(sizeof(float) * bins, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+  if (!aWeight) aWeight = (float*)heap_caps_malloc(sizeof(float) * bins, MALLOC_CAP_SPIRAM);
+  if (!aWeight) {
+    Serial.println("[FFT] Failed to allocate FFT buffers");
+    deinit();
+    return false;
+  }
+  for (size_t i = 0; i < bins; ++i) aWeight[i] = (float)aWeightingPower(Spec::frequencies[i]);
 
-  Serial.printf("[FFT] Engine initialized — %d bins, VOICE bins: %u–%u\n",
-                FFT_BINS, (unsigned)minVoiceBin, (unsigned)maxVoiceBin);
+  const double binHz = (double)Spec::sampleRate / (double)n;
+  auto edgeBin = [&](double hz) {
+    return (uint16_t)std::min((double)bins, ceil(hz / binHz));
+  };
+  for (size_t k = 0; k < THIRD_OCTAVE_BANDS; ++k) {
+    const double fc = 1000.0 * pow(10.0, (double)(THIRD_OCTAVE_FIRST + (int)k) / 10.0);
+    bandCenters[k] = (float)fc;
+    bandEdges[k] = edgeBin(fc * pow(10.0, -0.05));
+    if (k == THIRD_OCTAVE_BANDS - 1) bandEdges[k + 1] = edgeBin(fc * pow(10.0, 0.05));
+  }
+  // Pooled bin → power in V^2: one-sided Parseval for magnitudes, PSD * bin width for Welch
+#if FFT_POOL_POLICY == FFT_POOL_WELCH_PSD
+  binPowerScale = (float)binHz;
+#else
+  binPowerScale = (float)(2.0 / ((double)n * windowPower));
+#endif
+  windowPowerScale = (float)(2.0 / ((double)n * windowPower));
+
+#if FFT_BACKEND == FFT_BACKEND_ARDUINOFFT
+  for (Lane& lane : lanes) {
+    lane.vImag = (float*)heap_caps_malloc(sizeof(float) * n, MALLOC_CAP_SPIRAM);
+    if (!lane.vImag) {
+      Serial.println("[FFT] Failed to allocate FFT buffers");
+      deinit();
+      return false;
+    }
+
+    lane.fft = new ArduinoFFT<float>(lane.vReal, lane.vImag, (float)n, (float)Spec::sampleRate);
+    if (!lane.fft) {
+      Serial.println("[FFT] Failed to instantiate FFT object");
+      deinit();
+      return false;
+    }
+  }
+#else
+  // Twiddles + bit reversal computed once here instead of per window
+  if (!initRealFFTPlan(fftPlan, n)) {
+    Serial.println("[FFT] Failed to build FFT tables");
+    deinit();
+    return false;
+  }
+#endif
+
+#if FFT_PARALLEL
+  laneStop = false;
+  laneBusy = false;
+  laneStart = xSemaphoreCreateBinary();
+  laneDone  = xSemaphoreCreateBinary();
+  if (!laneStart || !laneDone ||
+      xTaskCreatePinnedToCore(laneWorkerTask, "FFTLane", 4096, this, FFT_WORKER_PRIORITY,
+                              &laneWorker, laneWorkerCore) != pdPASS) {
+    Serial.println("[FFT] Failed to start lane worker");
+    laneWorker = nullptr;
+    deinit();
+    return false;
+  }
+#endif
+
+  Serial.printf("[FFT] Engine initialized — %u bins, VOICE bins: %u–%u, backend: %s, lanes: %s, pool: %s\n",
+                (unsigned)bins, (unsigned)minVoiceBin, (unsigned)maxVoiceBin,
+                FFT_BACKEND == FFT_BACKEND_REAL ? "real" : "ArduinoFFT",
+                FFT_PARALLEL ? "2 (worker)" : "2 (inline)", fftPoolPolicyName(FFT_POOL_POLICY));
   return true;
 }
 
-void resetFFTEngine() {
+template <class Spec>
+void FFTEngineT<Spec>::reset() {
   fftReady = false;
   fftStatus = FFTStatus::NOT_READY;
   voiceDetected = false;
@@ -101,113 +208,626 @@ void resetFFTEngine() {
   confirmCnt = 0;
   voiceState = false;
   voiceIntensityDB = 0.0f;
+  // Quiet floor and counters survive like the baseline
+  frameQuiet = false;
+  lastLevelRMS = lastZcrHz = 0.0f;
+  for (float& level : bandLevels) level = LEVEL_DB_FLOOR;
+  laeqDB = LEVEL_DB_FLOOR;
+  spectralPeakCount = 0;
+  windowLevelRead = windowLevelSeq;
+  beginFrame();
 }
 
-bool processFFT(const float* mvSamples, size_t count) {
-  if (!mvSamples) {
+// === Input stage ===
+// Each hop is calibrated once into the staging ring (volts) and summed in the
+// same pass; a window is then (staged - mean) * Hamming over the last
+// fftSize / stepSize hops, with the mean built from the per-hop sums.
+struct MvSource {
+  const float* mv;
+  float operator[](size_t i) const { return mv[i] / MV_TO_V_SCALE; }  // mV → V
+};
+
+struct RawSource {
+  const uint16_t* raw;
+  const float* rawToVolts;
+  float operator[](size_t i) const { return rawToVolts[raw[i] & (ADC_RAW_CODES - 1)]; }
+};
+
+// With FFT_QUIET_GATE the same pass measures the hop's level about the last
+// hop mean: sum of squares and sign changes (zero crossings about DC).
+template <class Spec>
+template <class Src>
+float FFTEngineT<Spec>::stageHop(const Src& src, float* dst, HopLevel& level) {
+  const size_t step = Spec::step;
+#if FFT_QUIET_GATE
+  const float dc = levelDcValid ? levelDc : src[0];
+  bool neg = levelNegative;
+  uint32_t zc = 0;
+#endif
+#if FFT_INPUT_UNROLL >= 4
+  float s0 = 0.0f, s1 = 0.0f, s2 = 0.0f, s3 = 0.0f;
+#if FFT_QUIET_GATE
+  float q0 = 0.0f, q1 = 0.0f, q2 = 0.0f, q3 = 0.0f;
+#endif
+  for (size_t i = 0; i < step; i += 4) {
+    const float x0 = src[i], x1 = src[i + 1], x2 = src[i + 2], x3 = src[i + 3];
+    dst[i] = x0; dst[i + 1] = x1; dst[i + 2] = x2; dst[i + 3] = x3;
+    s0 += x0;
+    s1 += x1;
+    s2 += x2;
+    s3 += x3;
+#if FFT_QUIET_GATE
+    const float d0 = x0 - dc, d1 = x1 - dc, d2 = x2 - dc, d3 = x3 - dc;
+    q0 += d0 * d0;
+    q1 += d1 * d1;
+    q2 += d2 * d2;
+    q3 += d3 * d3;
+    const bool n0 = d0 < 0.0f, n1 = d1 < 0.0f, n2 = d2 < 0.0f, n3 = d3 < 0.0f;
+    zc += (uint32_t)(n0 != neg) + (uint32_t)(n1 != n0) + (uint32_t)(n2 != n1) + (uint32_t)(n3 != n2);
+    neg = n3;
+#endif
+  }
+  const float s = (s0 + s1) + (s2 + s3);
+#if FFT_QUIET_GATE
+  const float q = (q0 + q1) + (q2 + q3);
+#endif
+#else
+  float s = 0.0f;
+#if FFT_QUIET_GATE
+  float q = 0.0f;
+#endif
+  for (size_t i = 0; i < step; ++i) {
+    dst[i] = src[i];
+    s += dst[i];
+#if FFT_QUIET_GATE
+    const float d = dst[i] - dc;
+    q += d * d;
+    const bool n = d < 0.0f;
+    zc += (uint32_t)(n != neg);
+    neg = n;
+#endif
+  }
+#endif
+#if FFT_QUIET_GATE
+  level = HopLevel{ dc, q, zc };
+  levelDc = s / (float)step;
+  levelDcValid = true;
+  levelNegative = neg;
+#else
+  (void)level;
+#endif
+  return s;
+}
+
+template <class Spec>
+void FFTEngineT<Spec>::fillWindow(Lane& lane, size_t oldestSlot, float mean) const {
+  const size_t step = Spec::step;
+  for (size_t h = 0; h < Spec::hops; ++h) {
+    const float* src = staged + ((oldestSlot + h) % stageSlots) * step;
+    float* dst = lane.vReal + h * step;
+    const float* win = window + h * step;
+#if FFT_INPUT_UNROLL >= 4
+    for (size_t i = 0; i < step; i += 4) {
+      dst[i]     = (src[i]     - mean) * win[i];
+      dst[i + 1] = (src[i + 1] - mean) * win[i + 1];
+      dst[i + 2] = (src[i + 2] - mean) * win[i + 2];
+      dst[i + 3] = (src[i + 3] - mean) * win[i + 3];
+    }
+#else
+    for (size_t i = 0; i < step; ++i) {
+      dst[i] = (src[i] - mean) * win[i];
+    }
+#endif
+  }
+#if FFT_BACKEND == FFT_BACKEND_ARDUINOFFT
+  memset(lane.vImag, 0, sizeof(float) * Spec::size);
+#endif
+}
+
+// Transform the lane's filled window and pool it into the lane's accumulator.
+// Touches only the lane, its windowLevels[] entry and read-only engine tables:
+// safe on the worker task.
+template <class Spec>
+void FFTEngineT<Spec>::transformAndPool(Lane& lane) {
+  PROF_MARK(tp);
+#if FFT_BACKEND == FFT_BACKEND_ARDUINOFFT
+  lane.fft->compute(FFTDirection::Forward);
+  PROF_LAP_TO(lane.times, fftNs, tp);
+  lane.fft->complexToMagnitude();
+  PROF_LAP_TO(lane.times, magnitudeNs, tp);
+#else
+  realFFTForward(fftPlan, lane.vReal);
+  PROF_LAP_TO(lane.times, fftNs, tp);
+  realFFTMagnitude(fftPlan, lane.vReal);
+  PROF_LAP_TO(lane.times, magnitudeNs, tp);
+#endif
+
+  const float* mags = lane.vReal;
+  // A-weighted power of the window (Parseval): the level meter's input
+  float aPower = 0.0f;
+  for (size_t i = 0; i < bins; ++i) aPower += mags[i] * mags[i] * aWeight[i];
+  windowLevels[lane.levelSlot] = aPower * windowPowerScale;
+  PROF_LAP_TO(lane.times, levelNs, tp);
+
+#if FFT_POOL_POLICY == FFT_POOL_MEDIAN
+  // Keep the window itself; the per-bin selection runs in mergeLanes()
+  memcpy(lane.pool + (lane.windows % MEDIAN_SLOTS) * bins, mags, sizeof(float) * bins);
+#else
+  // First window of the lane starts a fresh accumulator
+  if (lane.windows == 0) memset(lane.pool, 0, sizeof(float) * bins);
+
+#if FFT_POOL_POLICY == FFT_POOL_MIXED
+  // Pool magnitudes: max in voice band, sum out-of-band (averaged in finalizeFrame())
+  for (size_t i = minVoiceBin; i < bandEnd; ++i) {
+    const float mag = mags[i] < MAGNITUDE_THRESHOLD ? 0.0f : mags[i]; // in-band gate
+    lane.pool[i] = fmaxf(lane.pool[i], mag);   // max pooling in voice band
+  }
+  forOutOfBand([&](size_t i) { lane.pool[i] += mags[i]; }); // accumulate for averaging later
+#elif FFT_POOL_POLICY == FFT_POOL_MAX
+  for (size_t i = 0; i < bins; ++i) lane.pool[i] = fmaxf(lane.pool[i], mags[i]);
+#elif FFT_POOL_POLICY == FFT_POOL_MEAN_MAG
+  for (size_t i = 0; i < bins; ++i) lane.pool[i] += mags[i];
+#elif FFT_POOL_POLICY == FFT_POOL_WELCH_PSD
+  for (size_t i = 0; i < bins; ++i) lane.pool[i] += mags[i] * mags[i];
+#else
+#error "Unknown FFT_POOL_POLICY"
+#endif
+#endif
+  PROF_LAP_TO(lane.times, poolNs, tp);
+  PROF_COUNT_TO(lane.times, windows);
+  lane.windows++;
+}
+
+#if FFT_PARALLEL
+template <class Spec>
+void FFTEngineT<Spec>::laneWorkerTask(void* arg) {
+  FFTEngineT* engine = (FFTEngineT*)arg;
+  for (;;) {
+    xSemaphoreTake(engine->laneStart, portMAX_DELAY);
+    if (engine->laneStop) break;
+    engine->transformAndPool(engine->lanes[1]);
+    xSemaphoreGive(engine->laneDone);
+  }
+  xSemaphoreGive(engine->laneDone);   // acknowledge the stop
+  vTaskDelete(nullptr);
+}
+
+template <class Spec>
+void FFTEngineT<Spec>::collectLane() {
+  if (!laneBusy) return;
+  xSemaphoreTake(laneDone, portMAX_DELAY);
+  laneBusy = false;
+}
+#else
+template <class Spec>
+void FFTEngineT<Spec>::collectLane() {}
+#endif
+
+// Window level from the per-hop stats, shifted from each hop's DC to the window
+// mean: sum (x - m)^2 = q + 2 (dc - m) sum (x - dc) + step (dc - m)^2.
+// Returns true when the window sits at the noise floor and its FFT can wait
+// for the rest of the frame. The floor follows quieter windows fast and louder ones slowly,
+// ignoring windows far above it (voice, events).
+template <class Spec>
+bool FFTEngineT<Spec>::gateWindow(size_t oldestSlot, float mean) {
+  constexpr float step = (float)Spec::step;
+  float sumSq = 0.0f;
+  uint32_t crossings = 0;
+  for (size_t h = 0; h < Spec::hops; ++h) {
+    const size_t slot = (oldestSlot + h) % stageSlots;
+    const HopLevel& level = hopLevels[slot];
+    const float offset = level.dc - mean;
+    sumSq += level.sumSq + 2.0f * offset * (hopSums[slot] - step * level.dc) + step * offset * offset;
+    crossings += level.crossings;
+  }
+  const float rms = sqrtf(fmaxf(sumSq, 0.0f) / (float)Spec::size);
+  frameLevelSq += rms * rms;
+  frameZcrHz += (float)crossings * (float)Spec::sampleRate / (float)Spec::size;
+  frameLevelWindows++;
+
+  const bool quiet = gateWarmup >= QUIET_WARMUP_WINDOWS &&
+                     rms < quietFloor * QUIET_FLOOR_MARGIN && rms < QUIET_MAX_RMS_V;
+
+  if (gateWarmup == 0) {
+    quietFloor = rms;                                   // initialize
+  } else if (rms < quietFloor) {
+    quietFloor += QUIET_FLOOR_DOWN * (rms - quietFloor);
+  } else if (rms < quietFloor * QUIET_TRACK_CEIL) {
+    quietFloor += QUIET_FLOOR_UP * (rms - quietFloor);
+  }
+  if (gateWarmup < QUIET_WARMUP_WINDOWS) gateWarmup++;
+
+  gateStats.noiseFloor = quietFloor;
+  return quiet;
+}
+
+template <class Spec>
+float FFTEngineT<Spec>::windowMean(size_t oldestSlot) const {
+  float sum = 0.0f;
+  for (size_t h = 0; h < Spec::hops; ++h) {
+    sum += hopSums[(oldestSlot + h) % stageSlots];   // oldest → newest
+  }
+  return sum / (float)Spec::size;
+}
+
+// Input stage here, then transform + pooling in lane (window index % LANES)
+template <class Spec>
+void FFTEngineT<Spec>::transformWindow(size_t oldestSlot, float mean) {
+  PROF_MARK(tp);
+  Lane& lane = lanes[frameWindows % LANES];
+  const size_t levelSlot = windowLevelSeq++ % FFT_WINDOW_LEVELS;
+#if FFT_PARALLEL
+  if (&lane == &lanes[1]) {
+    collectLane();                   // previous odd window must be done with vReal
+    lane.levelSlot = levelSlot;
+    fillWindow(lane, oldestSlot, mean);
+    PROF_LAP(inputNs, tp);
+    laneBusy = true;
+    xSemaphoreGive(laneStart);
+  } else
+#endif
+  {
+    lane.levelSlot = levelSlot;
+    fillWindow(lane, oldestSlot, mean);
+    PROF_LAP(inputNs, tp);
+    transformAndPool(lane);
+  }
+#if FFT_QUIET_GATE
+  gateStats.windowsRun++;
+#endif
+
+  frameWindows++;
+  if ((frameWindows & 3) == 0) vTaskDelay(0); // periodic yield (WDT-safe)
+}
+
+// Deferred quiet windows of the open frame, oldest first: the frame turned
+// out loud, so it pools every window in the order an ungated run would
+template <class Spec>
+void FFTEngineT<Spec>::runDeferred() {
+  for (size_t w = 0; w < deferredWindows; ++w) {
+    const size_t slot = (deferredSlot + w) % stageSlots;
+    transformWindow(slot, windowMean(slot));
+  }
+  deferredWindows = 0;
+}
+
+// One window over the last Spec::hops staged hops. With the quiet gate, quiet
+// windows are deferred while the frame has no louder one and the ring still
+// holds their hops; a frame too long for the ring is transformed in full.
+template <class Spec>
+void FFTEngineT<Spec>::runWindow() {
+  const size_t oldest = (stageHead + stageSlots - Spec::hops) % stageSlots;
+#if FFT_QUIET_GATE
+  PROF_MARK(tp);
+  const float mean = windowMean(oldest);
+  const bool quiet = gateWindow(oldest, mean);
+  PROF_LAP(inputNs, tp);
+  if (quiet && frameWindows == 0 && deferredWindows + Spec::hops < stageSlots) {
+    if (deferredWindows == 0) deferredSlot = oldest;
+    deferredWindows++;
+    return;
+  }
+  runDeferred();
+#else
+  const float mean = windowMean(oldest);
+#endif
+  transformWindow(oldest, mean);
+}
+
+template <class Spec>
+template <class Src>
+void FFTEngineT<Spec>::pushStaged(const Src& src) {
+  PROF_MARK(ts);
+  const size_t slot = stageHead;
+  hopSums[slot] = stageHop(src, staged + slot * Spec::step, hopLevels[slot]);
+  stageHead = (slot + 1) % stageSlots;
+  if (stagedHops < Spec::hops) stagedHops++;
+  PROF_LAP(inputNs, ts);
+
+  if (stagedHops == Spec::hops) runWindow();
+}
+
+template <class Spec>
+void FFTEngineT<Spec>::beginFrame() {
+  collectLane();
+  frameWindows = 0;
+  for (Lane& lane : lanes) lane.windows = 0;
+  frameLevelSq = frameZcrHz = 0.0f;
+  frameLevelWindows = 0;
+  deferredWindows = 0;
+  resetHopHistory();
+}
+
+template <class Spec>
+void FFTEngineT<Spec>::resetHopHistory() {
+  stageHead = 0;
+  stagedHops = 0;
+}
+
+template <class Spec>
+bool FFTEngineT<Spec>::pushHop(const uint16_t* raw, const float* rawToVolts) {
+  if (!raw || !rawToVolts || !staged) {
     fftStatus = FFTStatus::NULL_INPUT;
     return false;
   }
-  if (count < FFT_SIZE) {
-    fftStatus = FFTStatus::TOO_FEW_SAMPLES;
+  pushStaged(RawSource{ raw, rawToVolts });
+  return true;
+}
+
+template <class Spec>
+bool FFTEngineT<Spec>::pushHopMV(const float* mvSamples) {
+  if (!mvSamples || !staged) {
+    fftStatus = FFTStatus::NULL_INPUT;
     return false;
   }
+  pushStaged(MvSource{ mvSamples });
+  return true;
+}
 
-  memset(magnitudes, 0, sizeof(float) * FFT_BINS);
-  fftStatus = FFTStatus::OK;
-  size_t numFFTs = 0;
-
-  const size_t step = FFT_STEP_SIZE;
-  for (size_t offset = 0; offset + FFT_SIZE <= count; offset += step) {
-    float mean = 0.0f;
-    for (size_t i = 0; i < FFT_SIZE; ++i) {
-      vReal[i] = mvSamples[offset + i] / MV_TO_V_SCALE;  // convert mV → V
-      vImag[i] = 0.0f;
-      mean += vReal[i];
-    }
+// Lane merge in fixed lane order: max is order-free, sums are always
+// (lane 0) + (lane 1), whichever core produced each lane. Pooled bins are
+// finalized (averaged / scaled / selected) and the out-of-band energy summed in
+// the same pass; the voice band pass leaves its sum for the peak threshold of
+// the feature pass.
+template <class Spec>
+float FFTEngineT<Spec>::mergeLanes(size_t numFFTs) {
+  static_assert(LANES == 2, "mergeLanes() merges exactly two lanes");
+  const float* p0 = lanes[0].pool;
+  const float* p1 = lanes[1].pool;
+  const bool both = lanes[1].windows > 0;
+  const float windows = (float)numFFTs;
 
-    mean /= FFT_SIZE;
-    for (size_t i = 0; i < FFT_SIZE; ++i) {
-      vReal[i] -= mean; // DC removal
-    }
+#if FFT_POOL_POLICY == FFT_POOL_MIXED
+  auto bandBin = [&](size_t i) { return both ? fmaxf(p0[i], p1[i]) : p0[i]; };
+  auto outBin  = [&](size_t i) { return (both ? p0[i] + p1[i] : p0[i]) / windows; };
+#elif FFT_POOL_POLICY == FFT_POOL_MAX
+  auto bandBin = [&](size_t i) { return both ? fmaxf(p0[i], p1[i]) : p0[i]; };
+  auto outBin  = bandBin;
+  (void)windows;
+#elif FFT_POOL_POLICY == FFT_POOL_MEAN_MAG
+  auto bandBin = [&](size_t i) { return (both ? p0[i] + p1[i] : p0[i]) / windows; };
+  auto outBin  = bandBin;
+#elif FFT_POOL_POLICY == FFT_POOL_WELCH_PSD
+  // One-sided: every bin but DC carries the mirrored negative frequency too
+  const float scale = psdScale / windows;
+  auto bandBin = [&](size_t i) { return (both ? p0[i] + p1[i] : p0[i]) * (i == 0 ? scale : 2.0f * scale); };
+  auto outBin  = bandBin;
+#elif FFT_POOL_POLICY == FFT_POOL_MEDIAN
+  (void)both;
+  (void)windows;
+  const size_t n0 = std::min(lanes[0].windows, MEDIAN_SLOTS);
+  const size_t n1 = std::min(lanes[1].windows, MEDIAN_SLOTS);
+  float sel[2 * MEDIAN_SLOTS];
+  auto bandBin = [&](size_t i) {
+    size_t k = 0;
+    for (size_t w = 0; w < n0; ++w) sel[k++] = p0[w * bins + i];
+    for (size_t w = 0; w < n1; ++w) sel[k++] = p1[w * bins + i];
+    float* mid = sel + k / 2;
+    std::nth_element(sel, mid, sel + k);
+    if (k & 1) return *mid;
+    return 0.5f * (*mid + *std::max_element(sel, mid));   // even count: mean of the middle pair
+  };
+  auto outBin  = bandBin;
+#endif
 
-    FFT->windowing(FFTWindow::Hamming, FFTDirection::Forward);
-    FFT->compute(FFTDirection::Forward);
-    FFT->complexToMagnitude();
-
-    // Pool magnitudes: max in voice band, average out-of-band
-    for (size_t i = 0; i < FFT_BINS; ++i) {
-      float mag = vReal[i];
-      if (i >= minVoiceBin && i <= maxVoiceBin) {
-        if (mag < MAGNITUDE_THRESHOLD) mag = 0.0f; // in-band gate
-        magnitudes[i] = fmaxf(magnitudes[i], mag); // max pooling in voice band
-      } else {
-        magnitudes[i] += mag; // accumulate for averaging later
-      }
+  // Peaks are tracked one bin behind the write position; the first and last
+  // bin of each range wait until the neighbouring range is merged too
+  spectralPeakCount = 0;
+  float bandSum = 0.0f;
+  for (size_t i = minVoiceBin; i < bandEnd; ++i) {
+    const float m = bandBin(i);
+    magnitudes[i] = m;
+    bandSum += m;
+    if (i >= minVoiceBin + 2) trackPeak(i - 1);
+  }
+
+  noiseEnergy = 0.0f;
+  forOutOfBand([&](size_t i) {
+    const float m = outBin(i);
+    magnitudes[i] = m;
+    noiseEnergy += m * m;
+    if (i >= (i < minVoiceBin ? 2 : bandEnd + 2)) trackPeak(i - 1);
+  });
+  // Range edges: there is no bin below a band starting at DC, and a one-bin
+  // band has a single edge bin (offered once, or it takes two heap slots)
+  if (minVoiceBin > 0) trackPeak(minVoiceBin - 1);
+  trackPeak(minVoiceBin);
+  if (bandEnd - 1 > minVoiceBin) trackPeak(bandEnd - 1);
+  trackPeak(bandEnd);
+  return bandSum;
+}
+
+// Offer bin as a peak: a local maximum (plateaus count at their first bin)
+// stronger than the weakest of the K kept so far. DC and Nyquist never qualify.
+template <class Spec>
+inline void FFTEngineT<Spec>::trackPeak(size_t bin) {
+  if (bin == 0 || bin + 1 >= bins) return;
+  const float m = magnitudes[bin];
+  if (!(m > magnitudes[bin - 1] && m >= magnitudes[bin + 1])) return;
+
+  SpectralPeak* heap = spectralPeaks;
+  size_t child;
+  if (spectralPeakCount < SPECTRAL_PEAKS_K) {
+    // Sift up from the new leaf
+    child = spectralPeakCount++;
+    while (child > 0) {
+      const size_t parent = (child - 1) / 2;
+      if (heap[parent].magnitude <= m) break;
+      heap[child] = heap[parent];
+      child = parent;
     }
+    heap[child] = SpectralPeak{ 0.0f, m, (uint16_t)bin };
+    return;
+  }
+  if (m <= heap[0].magnitude) return;
+  // Replace the weakest and sift down
+  size_t node = 0;
+  while ((child = 2 * node + 1) < SPECTRAL_PEAKS_K) {
+    if (child + 1 < SPECTRAL_PEAKS_K && heap[child + 1].magnitude < heap[child].magnitude) child++;
+    if (heap[child].magnitude >= m) break;
+    heap[node] = heap[child];
+    node = child;
+  }
+  heap[node] = SpectralPeak{ 0.0f, m, (uint16_t)bin };
+}
 
-    numFFTs++;
-    if ((offset & (step * 4 - 1)) == 0) vTaskDelay(0); // periodic yield (WDT-safe)
+// Gaussian interpolation per kept peak: with a, b, c the log magnitudes of
+// bins k-1, k, k+1, the vertex sits at k + d, d = (a - c) / (2 (a - 2b + c)),
+// and the height is exp(b - (a - c) d / 4). Exact for a Gaussian lobe, close
+// for the Hamming main lobe; PSD (WELCH_PSD) bins give the same d.
+template <class Spec>
+void FFTEngineT<Spec>::refinePeaks() {
+  const float binHz = Spec::frequencies[1];
+  for (size_t p = 0; p < spectralPeakCount; ++p) {
+    SpectralPeak& peak = spectralPeaks[p];
+    const size_t k = peak.bin;
+    const float a = logf(magnitudes[k - 1] + EPS);
+    const float b = logf(magnitudes[k] + EPS);
+    const float c = logf(magnitudes[k + 1] + EPS);
+    const float curvature = a - 2.0f * b + c;
+    float d = curvature < 0.0f ? 0.5f * (a - c) / curvature : 0.0f;
+    d = fminf(fmaxf(d, -0.5f), 0.5f);
+    peak.frequency = ((float)k + d) * binHz;
+    peak.magnitude = expf(b - 0.25f * (a - c) * d);
   }
+  std::sort(spectralPeaks, spectralPeaks + spectralPeakCount,
+            [](const SpectralPeak& x, const SpectralPeak& y) { return x.magnitude > y.magnitude; });
+}
 
-  // Average out-of-band magnitudes
-  for (size_t i = 0; i < FFT_BINS; ++i) {
-    if (i < minVoiceBin || i > maxVoiceBin) {
-      magnitudes[i] /= (float)numFFTs;
-    }
+// A frame whose windows were all quiet (none transformed, see runWindow())
+// closes as a quiet frame: zero spectrum and spectral features, level
+// statistics, no voice; the baseline is left alone.
+template <class Spec>
+bool FFTEngineT<Spec>::finalizeFrame() {
+  collectLane();
+  if (frameWindows == 0 && deferredWindows == 0) {
+    fftStatus = FFTStatus::TOO_FEW_SAMPLES;
+    return false;
   }
+  lastLevelRMS = frameLevelWindows ? sqrtf(frameLevelSq / (float)frameLevelWindows) : 0.0f;
+  lastZcrHz = frameLevelWindows ? frameZcrHz / (float)frameLevelWindows : 0.0f;
+  frameLevelSq = frameZcrHz = 0.0f;
+  frameLevelWindows = 0;
+
+  frameQuiet = frameWindows == 0;
+  if (frameQuiet) {
+    memset(magnitudes, 0, sizeof(float) * bins);
+    voiceEnergy = noiseEnergy = snr = contrast = 0.0f;
+    peakCount = 0;
+    sfm = 1.0f;
+    bandRMS = noiseRMS = 0.0f;
+    voiceIntensityDB = 0.0f;
+    confirmCnt = 0;
+    voiceState = voiceDetected = false;
+    for (float& level : bandLevels) level = LEVEL_DB_FLOOR;
+    laeqDB = LEVEL_DB_FLOOR;
+    spectralPeakCount = 0;
+    gateStats.windowsSkipped += deferredWindows;
+    deferredWindows = 0;
+    gateStats.quietFrames++;
+    fftStatus = FFTStatus::QUIET;
+    PROF_COUNT(frames);
+    fftReady = true;
+    return true;
+  }
+
+  PROF_MARK(tm);
+  const float bandSum = mergeLanes(frameWindows);
+  refinePeaks();
+  PROF_LAP(poolNs, tm);
+  fftStatus = FFTStatus::OK;
+  extractFeatures(bandSum);
+  computeBandLevels();
+  frameWindows = 0;
+  for (Lane& lane : lanes) lane.windows = 0;
+  return true;
+}
+
+// === Whole-capture wrappers: the same hop path, one frame per call ===
+template <class Spec>
+bool FFTEngineT<Spec>::process(const float* mvSamples, size_t count) {
+  if (!mvSamples) {
+    fftStatus = FFTStatus::NULL_INPUT;
+    return false;
+  }
+  if (count < Spec::size) {
+    fftStatus = FFTStatus::TOO_FEW_SAMPLES;
+    return false;
+  }
+  beginFrame();
+  for (size_t offset = 0; offset + Spec::step <= count; offset += Spec::step) {
+    pushHopMV(mvSamples + offset);
+  }
+  return finalizeFrame();
+}
+
+template <class Spec>
+bool FFTEngineT<Spec>::processRaw(const uint16_t* raw, size_t count, const float* rawToVolts) {
+  if (!raw || !rawToVolts) {
+    fftStatus = FFTStatus::NULL_INPUT;
+    return false;
+  }
+  if (count < Spec::size) {
+    fftStatus = FFTStatus::TOO_FEW_SAMPLES;
+    return false;
+  }
+  beginFrame();
+  for (size_t offset = 0; offset + Spec::step <= count; offset += Spec::step) {
+    pushHop(raw + offset, rawToVolts);
+  }
+  return finalizeFrame();
+}
 
-  // === Feature extraction (existing + new) ===
-  voiceEnergy = noiseEnergy = 0.0f;
+// Fast natural log for x > 0 (normal floats): exponent split, mantissa folded
+// into [sqrt(2)/2, sqrt(2)), then log(m) = 2 atanh(s), s = (m-1)/(m+1), to s^7.
+// Branch-free; |error| < 2.1e-6 for x in [1e-9, 1e4] (< 1e-7 on [0.5, 2]),
+// against 1e-6 for logf(), so SFM stays within 1e-5 relative of the logf()
+// version (fft_bench --check).
+static inline float fastLogf(float x) {
+  uint32_t bits;
+  memcpy(&bits, &x, sizeof(bits));
+  int32_t e = (int32_t)(bits >> 23) - 127;
+  uint32_t mbits = (bits & 0x007FFFFFu) | 0x3F800000u;   // m in [1, 2)
+  const uint32_t fold = mbits >= 0x3FB504F3u;             // m >= sqrt(2): halve m
+  mbits -= fold << 23;
+  e += (int32_t)fold;
+  float m;
+  memcpy(&m, &mbits, sizeof(m));
+  const float s  = (m - 1.0f) / (m + 1.0f);
+  const float s2 = s * s;
+  const float logM = s * (2.0f + s2 * (0.6666667f + s2 * (0.4f + s2 * 0.2857143f)));
+  return (float)e * 0.69314718f + logM;
+}
+
+// One pass over the voice band for energy, max, log-sum and peaks; the band
+// sum (peak threshold) and the out-of-band energy come from mergeLanes().
+template <class Spec>
+void FFTEngineT<Spec>::extractFeatures(float bandSum) {
+  PROF_MARK(tf);
+
+  const float meanVoice = bandSum / (float)bandBins;
+  const float peakLevel = meanVoice * 1.5f;
+  voiceEnergy = 0.0f;
   peakCount = 0;
   float maxVoice = 0.0f;
-  float meanVoice = 0.0f;
-
-  for (size_t i = 0; i < FFT_BINS; ++i) {
-    float mag = magnitudes[i];
-    if (i >= minVoiceBin && i <= maxVoiceBin) {
-      voiceEnergy += mag * mag;
-      meanVoice += mag;
-      if (mag > maxVoice) maxVoice = mag;
-    } else {
-      noiseEnergy += mag * mag;
-    }
+  float logSum = 0.0f;
+  for (size_t i = minVoiceBin; i < bandEnd; ++i) {
+    const float m = magnitudes[i];
+    voiceEnergy += m * m;
+    maxVoice = fmaxf(maxVoice, m);
+    logSum += fastLogf(m + EPS);
+    peakCount += m > peakLevel;
   }
-  meanVoice /= (maxVoiceBin - minVoiceBin + 1);
 
   // Contrast + peaks kept for backward compatibility/logging
   contrast = (meanVoice > 0.0f) ? (maxVoice / meanVoice) : 0.0f;
-  for (size_t i = minVoiceBin; i <= maxVoiceBin; ++i) {
-    if (magnitudes[i] > meanVoice * 1.5f) {
-      peakCount++;
-    }
-  }
 
-  // New: RMS in/out band + spectral flatness in band
-  bandRMS = 0.0f;
-  noiseRMS = 0.0f;
-  float bandSum = 0.0f;
-  float logSum  = 0.0f;
-  size_t bandBins  = (maxVoiceBin - minVoiceBin + 1);
-  size_t noiseBins = 0;
-
-  for (size_t i = 0; i < FFT_BINS; ++i) {
-    float m = magnitudes[i];
-    if (i >= minVoiceBin && i <= maxVoiceBin) {
-      bandRMS += m * m;
-      bandSum += m;
-      logSum  += logf(m + EPS);
-    } else {
-      noiseRMS += m * m;
-      noiseBins++;
-    }
-  }
-  bandRMS  = sqrtf(bandRMS / (float)bandBins);
-  noiseRMS = (noiseBins > 0) ? sqrtf(noiseRMS / (float)noiseBins) : 0.0f;
+  // RMS in/out band + spectral flatness in band
+  bandRMS  = sqrtf(voiceEnergy / (float)bandBins);
+  noiseRMS = (noiseBins > 0) ? sqrtf(noiseEnergy / (float)noiseBins) : 0.0f;
 
-  float amean = bandSum / (float)bandBins;
   float gmean = expf(logSum / (float)bandBins);
-  sfm = gmean / (amean + EPS); // 0 = peaky (voiced), 1 = flat (noise)
+  sfm = gmean / (meanVoice + EPS); // 0 = peaky (voiced), 1 = flat (noise)
 
   // Update adaptive baseline only when not currently in voice state
   if (!voiceState) {
@@ -246,55 +866,205 @@ bool processFFT(const float* mvSamples, size_t count) {
     snr, sfm, riseDB, deltaE, peakCount, contrast, voiceDetected ? "YES" : "no");
 #endif
 
+  PROF_LAP(featureNs, tf);
+  PROF_COUNT(frames);
   fftReady = true;
-  return true;
 }
 
-bool isFFTReady()          { return fftReady; }
-void resetFFTReady()       { fftReady = false; }
-FFTStatus getFFTStatus()   { return fftStatus; }
+// 1/3-octave band powers and the A-weighted total in one pass over the pooled
+// spectrum. MIXED pools the voice band by (gated) max, so its band levels
+// there read high against a true Leq; MEAN_MAG or WELCH_PSD give the
+// textbook values.
+template <class Spec>
+void FFTEngineT<Spec>::computeBandLevels() {
+  PROF_MARK(tb);
+  auto binPower = [&](size_t i) {
+#if FFT_POOL_POLICY == FFT_POOL_WELCH_PSD
+    return magnitudes[i] * binPowerScale;
+#else
+    return magnitudes[i] * magnitudes[i] * binPowerScale;
+#endif
+  };
+  // fastLogf(0) is about -88, far under the floor, so empty bands clamp there
+  auto toDB = [](float power) {
+    return fmaxf(4.3429448f * fastLogf(power) + LEVEL_DB_OFFSET, LEVEL_DB_FLOOR);   // 10 log10
+  };
 
-bool isVoiceDetected()     { return voiceDetected; }
-float getVoiceSNR()        { return snr; }
-float getVoiceEnergy()     { return voiceEnergy; }
-int   getVoicePeakCount()  { return peakCount; }
-float getVoiceContrast()   { return contrast; }
+  float aPower = 0.0f;
+  for (size_t i = 0; i < bandEdges[0]; ++i) aPower += binPower(i) * aWeight[i];
+  for (size_t k = 0; k < THIRD_OCTAVE_BANDS; ++k) {
+    float power = 0.0f;
+    for (size_t i = bandEdges[k]; i < bandEdges[k + 1]; ++i) {
+      const float p = binPower(i);
+      power += p;
+      aPower += p * aWeight[i];
+    }
+    bandLevels[k] = toDB(power);
+  }
+  for (size_t i = bandEdges[THIRD_OCTAVE_BANDS]; i < bins; ++i) aPower += binPower(i) * aWeight[i];
+  laeqDB = toDB(aPower);
+  PROF_LAP(featureNs, tb);
+}
 
-const float* getFFTMagnitudes()  { return magnitudes; }
-const float* getFFTFrequencies() { return frequencies; }
-size_t getFFTBins()              { return FFT_BINS; }
+template <class Spec>
+size_t FFTEngineT<Spec>::drainWindowLevels(float* out, size_t maxCount) {
+  if (!out) return 0;
+  collectLane();   // the worker's last window is written by now
+  if (windowLevelSeq - windowLevelRead > FFT_WINDOW_LEVELS) {
+    windowLevelRead = windowLevelSeq - FFT_WINDOW_LEVELS;   // older entries overwritten
+  }
+  size_t n = 0;
+  while (n < maxCount && windowLevelRead != windowLevelSeq) {
+    out[n++] = windowLevels[windowLevelRead++ % FFT_WINDOW_LEVELS];
+  }
+  return n;
+}
 
-float getDominantFrequency(float& magnitudeOut) {
-  magnitudeOut = 0.0f;
-  if (!magnitudes || !frequencies || FFT_BINS == 0) return 0.0f;
+template <class Spec>
+FFTFeatures FFTEngineT<Spec>::getFeatures() const {
+  return FFTFeatures{ voiceDetected, snr, voiceEnergy, peakCount, contrast, voiceIntensityDB,
+                      frameQuiet, lastLevelRMS, lastZcrHz, quietFloor, laeqDB,
+                      sfm, bandRMS, noiseRMS };
+}
 
-  size_t peakIdx = 0;
-  float peak = 0.0f;
-  for (size_t i = 0; i < FFT_BINS; i++) {
-    if (magnitudes[i] > peak) {
-      peak = magnitudes[i];
-      peakIdx = i;
-    }
+template <class Spec>
+float FFTEngineT<Spec>::getDominantFrequency(float& magnitudeOut) const {
+  // Strongest tracked peak (interpolated); 0 Hz / 0 when the frame had none
+  if (spectralPeakCount == 0) {
+    magnitudeOut = 0.0f;
+    return 0.0f;
   }
-  magnitudeOut = peak;
-  return frequencies[peakIdx];
+  magnitudeOut = spectralPeaks[0].magnitude;
+  return spectralPeaks[0].frequency;
+}
+
+template <class Spec>
+size_t FFTEngineT<Spec>::getSpectralPeaks(SpectralPeak* out, size_t k) const {
+  if (!out) return 0;
+  const size_t n = std::min(k, spectralPeakCount);
+  memcpy(out, spectralPeaks, sizeof(SpectralPeak) * n);
+  return n;
 }
 
-// === Optional new getters (add to fft_engine.h only if you plan to use them) ===
-float getVoiceIntensityDB() { return voiceIntensityDB; }
 // 0–100 scale mapped from 0–20 dB
-float getVoiceIntensityPct() {
+template <class Spec>
+float FFTEngineT<Spec>::getIntensityPct() const {
   float pct = (voiceIntensityDB / 20.0f) * 100.0f;
   if (pct < 0.0f) pct = 0.0f;
   if (pct > 100.0f) pct = 100.0f;
   return pct;
 }
 
-void deinitFFTEngine() {
-  resetFFTEngine();
-  if (vReal)       { free(vReal); vReal = nullptr; }
-  if (vImag)       { free(vImag); vImag = nullptr; }
+template <class Spec>
+const FFTStageTimes& FFTEngineT<Spec>::getStageTimes() {
+  collectLane();
+  stageTotals = stageTimes;
+  for (const Lane& lane : lanes) {
+    stageTotals.fftNs       += lane.times.fftNs;
+    stageTotals.magnitudeNs += lane.times.magnitudeNs;
+    stageTotals.poolNs      += lane.times.poolNs;
+    stageTotals.levelNs     += lane.times.levelNs;
+    stageTotals.windows     += lane.times.windows;
+  }
+  return stageTotals;
+}
+
+template <class Spec>
+void FFTEngineT<Spec>::resetStageTimes() {
+  collectLane();
+  stageTimes = FFTStageTimes{};
+  for (Lane& lane : lanes) lane.times = FFTStageTimes{};
+}
+
+template <class Spec>
+void FFTEngineT<Spec>::deinit() {
+  reset();
+#if FFT_PARALLEL
+  if (laneWorker) {
+    laneStop = true;
+    xSemaphoreGive(laneStart);
+    xSemaphoreTake(laneDone, portMAX_DELAY);   // worker has left its loop
+    laneWorker = nullptr;
+  }
+  if (laneStart) { vSemaphoreDelete(laneStart); laneStart = nullptr; }
+  if (laneDone)  { vSemaphoreDelete(laneDone); laneDone = nullptr; }
+#endif
+  for (Lane& lane : lanes) {
+    if (lane.vReal) { free(lane.vReal); lane.vReal = nullptr; }
+    if (lane.pool)  { free(lane.pool); lane.pool = nullptr; }
+#if FFT_BACKEND == FFT_BACKEND_ARDUINOFFT
+    if (lane.vImag) { free(lane.vImag); lane.vImag = nullptr; }
+    if (lane.fft)   { delete lane.fft; lane.fft = nullptr; }
+#endif
+  }
   if (magnitudes)  { free(magnitudes); magnitudes = nullptr; }
-  if (frequencies) { free(frequencies); frequencies = nullptr; }
-  if (FFT)         { delete FFT; FFT = nullptr; }
+  if (window)      { free(window); window = nullptr; }
+  if (aWeight)     { free(aWeight); aWeight = nullptr; }
+  if (staged)      { free(staged); staged = nullptr; }
+#if FFT_BACKEND == FFT_BACKEND_REAL
+  deinitRealFFTPlan(fftPlan);
+#endif
+}
+
+template class FFTEngineT<DefaultFFTSpec>;
+
+// === C API: default instance ===
+FFTEngine& defaultFFTEngine() {
+  static FFTEngine engine;
+  return engine;
+}
+
+bool initFFTEngine()    { return defaultFFTEngine().init(); }
+void deinitFFTEngine()  { defaultFFTEngine().deinit(); }
+void resetFFTEngine()   { defaultFFTEngine().reset(); }
+
+bool processFFT(const float* mvSamples, size_t count) {
+  return defaultFFTEngine().process(mvSamples, count);
 }
+bool processFFTRaw(const uint16_t* raw, size_t count, const float* rawToVolts) {
+  return defaultFFTEngine().processRaw(raw, count, rawToVolts);
+}
+
+void beginFrame()        { defaultFFTEngine().beginFrame(); }
+void resetHopHistory()   { defaultFFTEngine().resetHopHistory(); }
+bool pushHop(const uint16_t* raw, const float* rawToVolts) { return defaultFFTEngine().pushHop(raw, rawToVolts); }
+bool pushHopMV(const float* mvSamples)                     { return defaultFFTEngine().pushHopMV(mvSamples); }
+bool finalizeFrame()     { return defaultFFTEngine().finalizeFrame(); }
+size_t getFrameWindows() { return defaultFFTEngine().getFrameWindows(); }
+
+bool isFFTReady()          { return defaultFFTEngine().isReady(); }
+void resetFFTReady()       { defaultFFTEngine().resetReady(); }
+FFTStatus getFFTStatus()   { return defaultFFTEngine().getStatus(); }
+
+FFTFeatures getFFTFeatures() { return defaultFFTEngine().getFeatures(); }
+bool isVoiceDetected()     { return defaultFFTEngine().getFeatures().voice; }
+float getVoiceSNR()        { return defaultFFTEngine().getFeatures().snr; }
+float getVoiceEnergy()     { return defaultFFTEngine().getFeatures().energy; }
+int   getVoicePeakCount()  { return defaultFFTEngine().getFeatures().peakCount; }
+float getVoiceContrast()   { return defaultFFTEngine().getFeatures().contrast; }
+
+const float* getFFTMagnitudes()  { return defaultFFTEngine().getMagnitudes(); }
+const float* getFFTFrequencies() { return defaultFFTEngine().getFrequencies(); }
+size_t getFFTBins()              { return defaultFFTEngine().getBins(); }
+
+float getDominantFrequency(float& magnitudeOut) { return defaultFFTEngine().getDominantFrequency(magnitudeOut); }
+size_t getSpectralPeaks(SpectralPeak* out, size_t k) { return defaultFFTEngine().getSpectralPeaks(out, k); }
+float getVoiceIntensityDB()  { return defaultFFTEngine().getIntensityDB(); }
+float getVoiceIntensityPct() { return defaultFFTEngine().getIntensityPct(); }
+
+const float* getFFTBandLevels()  { return defaultFFTEngine().getBandLevels(); }
+const float* getFFTBandCenters() { return defaultFFTEngine().getBandCenters(); }
+float getFFTLAeq()               { return defaultFFTEngine().getLAeq(); }
+size_t drainFFTWindowLevels(float* out, size_t maxCount) {
+  return defaultFFTEngine().drainWindowLevels(out, maxCount);
+}
+
+const FFTStageTimes& getFFTStageTimes() { return defaultFFTEngine().getStageTimes(); }
+void resetFFTStageTimes()               { defaultFFTEngine().resetStageTimes(); }
+
+const QuietGateStats& getQuietGateStats() { return defaultFFTEngine().getGateStats(); }
+
+#if FFT_PARALLEL
+void setFFTLaneWorkerCore(BaseType_t core) { defaultFFTEngine().setLaneWorkerCore(core); }
+TaskHandle_t getFFTLaneWorker()            { return defaultFFTEngine().getLaneWorker(); }
+#endif
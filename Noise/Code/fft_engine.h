@@ -2,31 +2,428 @@
 
 #include <Arduino.h>
 #include <stdint.h>
+#include <array>
+#include "signal_config.h"
 
 // === Optional compile-time debug ===
 #define DEBUG_FFT_VALUES false
 
+// === FFT backend ===
+#define FFT_BACKEND_ARDUINOFFT  0   // N-point complex ArduinoFFT<float> (reference path)
+#define FFT_BACKEND_REAL        1   // N/2-point complex + split, tables built in initFFTEngine()
+#ifndef FFT_BACKEND
+#define FFT_BACKEND FFT_BACKEND_REAL
+#endif
+
+// === Input stage: 4 = unrolled 4-lane kernel, 1 = scalar reference loop ===
+#ifndef FFT_INPUT_UNROLL
+#define FFT_INPUT_UNROLL 4
+#endif
+
+// === Optional per-stage timing (host replay bench / serial diagnostics) ===
+#ifndef FFT_ENGINE_PROFILE
+#define FFT_ENGINE_PROFILE false
+#endif
+
+// === Window lanes: odd windows run on a worker task (setLaneWorkerCore()) ===
+// Output is bit-identical either way (fixed lane order in the merge).
+#ifndef FFT_PARALLEL
+#define FFT_PARALLEL false
+#endif
+#ifndef FFT_WORKER_PRIORITY
+#define FFT_WORKER_PRIORITY 2
+#endif
+
+// === Pooling policy: how a frame's windows combine into one spectrum ===
+// The code is stored in the log header (reserved[0]); MIXED is 0 so older logs
+// read as MIXED. Detector thresholds are tuned on MIXED.
+#define FFT_POOL_MIXED      0   // max in voice band (gated), mean magnitude outside
+#define FFT_POOL_MAX        1   // max magnitude, every bin
+#define FFT_POOL_MEAN_MAG   2   // mean magnitude, every bin
+#define FFT_POOL_WELCH_PSD  3   // Welch PSD: mean |X|^2 / (fs * sum w^2), one-sided, V^2/Hz
+#define FFT_POOL_MEDIAN     4   // per-bin median of up to FFT_POOL_MEDIAN_WINDOWS windows
+#ifndef FFT_POOL_POLICY
+#define FFT_POOL_POLICY FFT_POOL_MIXED
+#endif
+#ifndef FFT_POOL_MEDIAN_WINDOWS
+#define FFT_POOL_MEDIAN_WINDOWS 16   // selection depth; longer frames keep the latest ones
+#endif
+const char* fftPoolPolicyName(uint8_t policy);
+
+// === Quiet gate: skip the FFTs of frames whose RMS sits at the noise floor ===
+// Level (RMS, zero-crossing rate) is measured per window in the input stage.
+// Quiet windows wait in the hop ring until the frame has a louder one (then
+// they are transformed, and the frame pools exactly as without the gate) or
+// closes; a frame whose windows were all quiet closes as a quiet frame (level
+// statistics, no spectrum). Quiet frames leave the voice baseline alone, so
+// the decisions after a silence can differ from an ungated run: off until the
+// detector is tuned with it.
+#ifndef FFT_QUIET_GATE
+#define FFT_QUIET_GATE false
+#endif
+#ifndef FFT_QUIET_FRAME_SAMPLES
+#define FFT_QUIET_FRAME_SAMPLES TOTAL_SAMPLES   // longest frame gated as a whole
+#endif
+
+// === Band levels: base-10 1/3-octave bands 100 Hz – 16 kHz + A-weighted Leq ===
+// Levels are dB re 1 V^2 of the ADC input; LEVEL_DB_OFFSET maps them to dB SPL
+// once the mic sensitivity and preamp gain are known. Band k has its exact
+// centre at 1000 * 10^((THIRD_OCTAVE_FIRST + k) / 10) Hz.
+#define THIRD_OCTAVE_BANDS  23
+#define THIRD_OCTAVE_FIRST  (-10)      // 100 Hz band
+#ifndef LEVEL_DB_OFFSET
+#define LEVEL_DB_OFFSET     0.0f
+#endif
+#define LEVEL_DB_FLOOR      (-150.0f)  // empty band / quiet frame
+#define FFT_WINDOW_LEVELS   (TOTAL_SAMPLES / FFT_STEP_SIZE + 2)   // a frame's window powers, held until drained
+
+// === Spectral peaks: the K strongest local maxima of the pooled spectrum ===
+// Tracked while the lanes are merged (no extra pass over the bins) and refined
+// to sub-bin frequency by Gaussian interpolation: a parabola through the log
+// magnitudes of the peak bin and its two neighbours.
+#ifndef SPECTRAL_PEAKS_K
+#define SPECTRAL_PEAKS_K    8
+#endif
+
+struct SpectralPeak {
+  float frequency;      // Hz, interpolated
+  float magnitude;      // interpolated height, in pooled-spectrum units
+  uint16_t bin;         // local-maximum bin
+};
+
+#if FFT_BACKEND == FFT_BACKEND_ARDUINOFFT
+template <typename T> class ArduinoFFT;
+#else
+#include "real_fft.h"
+#endif
+#if FFT_PARALLEL
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#endif
+
 // === FFT status codes ===
 enum class FFTStatus {
   OK,
   NOT_READY,
   NULL_INPUT,
-  TOO_FEW_SAMPLES
+  TOO_FEW_SAMPLES,
+  QUIET                 // frame closed without FFTs: level statistics only
+};
+
+// === Voice band of the default engine (pooled by max, used for detection) ===
+#define VOICE_MIN_HZ 100
+#define VOICE_MAX_HZ 4000
+
+// === Compile-time engine spec ===
+// Everything derived from size, hop, rate and voice band: bin edges and the
+// bin frequency table are constants (the table lives in flash).
+template <size_t Bins>
+constexpr std::array<float, Bins> makeBinFrequencies(uint32_t rate, size_t size) {
+  std::array<float, Bins> f{};
+  for (size_t i = 0; i < Bins; ++i) f[i] = ((float)i * (float)rate) / (float)size;
+  return f;
+}
+
+template <size_t Size, size_t Step, uint32_t Rate, uint32_t VoiceMinHz, uint32_t VoiceMaxHz>
+struct FFTSpec {
+  static_assert(Size >= 8 && (Size & (Size - 1)) == 0, "FFT size must be a power of two >= 8");
+  static_assert(Step > 0 && Size % Step == 0, "FFT size must be a multiple of the hop");
+  static_assert(Step % 4 == 0, "hop must be a multiple of 4 (unrolled input stage)");
+  static_assert(Rate > 0, "sample rate must be positive");
+  static_assert(VoiceMinHz <= VoiceMaxHz, "voice band edges out of order");
+  static_assert((uint64_t)VoiceMinHz * Size / Rate < Size / 2, "voice band starts above Nyquist");
+
+  static constexpr size_t size = Size;
+  static constexpr size_t step = Step;
+  static constexpr size_t bins = Size / 2;
+  static constexpr size_t hops = Size / Step;          // hops per window
+  static constexpr uint32_t sampleRate = Rate;
+  static constexpr size_t minVoiceBin = (size_t)((uint64_t)VoiceMinHz * Size / Rate);
+  static constexpr size_t maxVoiceBin = (uint64_t)VoiceMaxHz * Size / Rate < bins
+                                          ? (size_t)((uint64_t)VoiceMaxHz * Size / Rate) : bins - 1;
+  static constexpr std::array<float, bins> frequencies = makeBinFrequencies<bins>(Rate, Size);
+};
+
+// signal_config.h values: the spec of the C API's engine
+using DefaultFFTSpec = FFTSpec<FFT_SIZE, FFT_STEP_SIZE, SAMPLE_RATE, VOICE_MIN_HZ, VOICE_MAX_HZ>;
+static_assert(DefaultFFTSpec::bins == FFT_BINS, "FFT_BINS out of sync with FFT_SIZE");
+
+// === Feature snapshot (values of the last finalized frame) ===
+struct FFTFeatures {
+  bool voice;
+  float snr;
+  float energy;
+  int peakCount;
+  float contrast;
+  float intensityDB;
+  // Time-domain level over the frame's windows (zero with FFT_QUIET_GATE off)
+  bool quiet;           // every window gated: spectrum and spectral features are zero
+  float levelRMS;       // V, DC removed
+  float zcrHz;          // zero crossings per second about the DC level
+  float noiseFloor;     // V, gate floor when the frame closed
+  float laeqDB;         // A-weighted level of the pooled spectrum (LEVEL_DB_FLOOR when quiet)
+  // Inputs of the voice decision (1 / 0 / 0 when quiet)
+  float sfm;            // spectral flatness in the voice band
+  float bandRMS;        // RMS magnitude in the voice band
+  float noiseRMS;       // RMS magnitude outside it
+};
+
+// === Quiet gate counters (since init) ===
+struct QuietGateStats {
+  uint32_t windowsRun;      // windows transformed
+  uint32_t windowsSkipped;  // windows of quiet frames (FFT skipped)
+  uint32_t quietFrames;     // frames closed with every window gated
+  float noiseFloor;         // V, current gate floor
+};
+
+// === Profiling (all zero unless FFT_ENGINE_PROFILE) ===
+struct FFTStageTimes {
+  uint64_t inputNs;      // fused calibration + DC removal + Hamming window
+  uint64_t fftNs;        // forward transform
+  uint64_t magnitudeNs;  // complex → magnitude
+  uint64_t poolNs;       // per-window pooling into magnitudes[]
+  uint64_t levelNs;      // per-window A-weighted power (level meter input)
+  uint64_t featureNs;    // out-of-band averaging + features + decision
+  uint32_t windows;      // FFT windows accounted
+  uint32_t frames;       // processFFT() calls accounted
 };
+// === FFT engine ===
+// Owns its buffers, hop history, lanes and detector state; instances are
+// independent (one per band/resolution, or one per replay thread on host).
+// Members are defined in fft_engine.cpp, which instantiates DefaultFFTSpec;
+// another spec needs its own explicit instantiation there.
+// The C API below drives defaultFFTEngine().
+template <class SpecT>
+class FFTEngineT {
+public:
+  using Spec = SpecT;
 
-// === Lifecycle ===
+  FFTEngineT() = default;
+  ~FFTEngineT();
+  FFTEngineT(const FFTEngineT&) = delete;
+  FFTEngineT& operator=(const FFTEngineT&) = delete;
+
+  // Lifecycle
+  bool init();
+  void deinit();
+  void reset();                 // soft reset, keeps buffers and noise baseline
+
+  // Processing (see the C API below for semantics)
+  bool process(const float* mvSamples, size_t count);
+  bool processRaw(const uint16_t* raw, size_t count, const float* rawToVolts);
+  void beginFrame();
+  void resetHopHistory();
+  bool pushHop(const uint16_t* raw, const float* rawToVolts);
+  bool pushHopMV(const float* mvSamples);
+  bool finalizeFrame();
+  size_t getFrameWindows() const { return frameWindows; }
+
+  // State and results
+  bool isReady() const          { return fftReady; }
+  void resetReady()             { fftReady = false; }
+  FFTStatus getStatus() const   { return fftStatus; }
+  FFTFeatures getFeatures() const;
+  const float* getMagnitudes() const   { return magnitudes; }
+  const float* getFrequencies() const  { return Spec::frequencies.data(); }
+  static constexpr size_t getBins()    { return Spec::bins; }
+  float getDominantFrequency(float& magnitudeOut) const;   // strongest spectral peak
+  size_t getSpectralPeaks(SpectralPeak* out, size_t k) const;   // strongest first
+  float getIntensityDB() const  { return voiceIntensityDB; }
+  float getSpectralFlatness() const { return sfm; }   // voice band, fast-log (see fastLogf)
+  float getIntensityPct() const;
+  const float* getBandLevels() const   { return bandLevels; }     // dB, THIRD_OCTAVE_BANDS
+  const float* getBandCenters() const  { return bandCenters; }    // Hz, exact
+  static constexpr size_t getBandCount() { return THIRD_OCTAVE_BANDS; }
+  float getLAeq() const         { return laeqDB; }
+  size_t drainWindowLevels(float* out, size_t maxCount);
+
+  // Profiling
+  const FFTStageTimes& getStageTimes();
+  void resetStageTimes();
+  const QuietGateStats& getGateStats() const { return gateStats; }
+#if FFT_PARALLEL
+  void setLaneWorkerCore(BaseType_t core) { laneWorkerCore = core; }   // before init()
+  TaskHandle_t getLaneWorker() const { return laneWorker; }
+#endif
+
+private:
+  // Window w of a frame always lands in lane w % LANES, and each lane pools its
+  // own windows (in-band max, out-of-band sum). finalizeFrame() merges the lanes
+  // in lane order, so the pooled spectrum is bit-identical whether lane 1 runs
+  // inline (default) or on the worker task (FFT_PARALLEL).
+  static constexpr size_t LANES = 2;
+  static constexpr size_t MEDIAN_SLOTS = (FFT_POOL_MEDIAN_WINDOWS + LANES - 1) / LANES;   // per lane
+  static constexpr size_t POOL_FLOATS = (FFT_POOL_POLICY == FFT_POOL_MEDIAN ? MEDIAN_SLOTS : 1) * SpecT::bins;
+  static constexpr size_t bins = Spec::bins;
+  static constexpr size_t minVoiceBin = Spec::minVoiceBin;
+  static constexpr size_t maxVoiceBin = Spec::maxVoiceBin;
+  static constexpr size_t bandEnd = maxVoiceBin + 1;               // voice band is [minVoiceBin, bandEnd)
+  static constexpr size_t bandBins = bandEnd - minVoiceBin;
+  static constexpr size_t noiseBins = bins - bandBins;
+
+  // Out-of-band bins in index order, as two branch-free ranges around the band
+  template <class F> static void forOutOfBand(F&& f) {
+    for (size_t i = 0; i < minVoiceBin; ++i) f(i);
+    for (size_t i = bandEnd; i < bins; ++i) f(i);
+  }
+  struct Lane {
+    float* vReal;              // window in, magnitudes out (FFT scratch)
+    float* pool;               // this lane's pooled windows (MEDIAN: MEDIAN_SLOTS windows)
+    size_t windows;            // windows pooled into this lane in the open frame
+    size_t levelSlot;          // windowLevels[] entry of the lane's current window
+#if FFT_BACKEND == FFT_BACKEND_ARDUINOFFT
+    float* vImag;
+    ArduinoFFT<float>* fft;
+#endif
+    FFTStageTimes times;       // fft/magnitude/pool time of windows run by this lane
+  };
+
+  template <class Src> void pushStaged(const Src& src);
+  // Level of one staged hop about the running DC estimate (dc): squares of
+  // x - dc stay small, so the window variance does not cancel in float
+  struct HopLevel {
+    float dc;
+    float sumSq;
+    uint32_t crossings;
+  };
+
+  template <class Src> float stageHop(const Src& src, float* dst, HopLevel& level);
+  void fillWindow(Lane& lane, size_t oldestSlot, float mean) const;
+  void transformAndPool(Lane& lane);
+  bool gateWindow(size_t oldestSlot, float mean);
+  float windowMean(size_t oldestSlot) const;
+  void transformWindow(size_t oldestSlot, float mean);
+  void runDeferred();
+  void runWindow();
+  void collectLane();
+  float mergeLanes(size_t numFFTs);
+  inline void trackPeak(size_t bin);
+  void refinePeaks();
+  void extractFeatures(float bandSum);
+  void computeBandLevels();
+#if FFT_PARALLEL
+  static void laneWorkerTask(void* arg);
+#endif
+
+  // Buffers
+  float* magnitudes = nullptr;
+  float* window = nullptr;            // Hamming coefficients, built once
+  float psdScale = 0.0f;              // WELCH_PSD: 1 / (fs * sum w^2)
+  float* aWeight = nullptr;           // A-weighting power gain per bin, built once
+  float binPowerScale = 0.0f;         // pooled bin → V^2 (see computeBandLevels())
+  uint16_t bandEdges[THIRD_OCTAVE_BANDS + 1] = {};   // band k = bins [edges[k], edges[k+1])
+  float bandCenters[THIRD_OCTAVE_BANDS] = {};
+  float bandLevels[THIRD_OCTAVE_BANDS] = {};
+  float laeqDB = LEVEL_DB_FLOOR;
+  // A-weighted power of every transformed window, in window order
+  float windowPowerScale = 0.0f;      // window |X|^2 → V^2 (one-sided Parseval)
+  float windowLevels[FFT_WINDOW_LEVELS] = {};
+  uint32_t windowLevelSeq = 0;        // windows transformed
+  uint32_t windowLevelRead = 0;       // windows drained
+  // Min-heap on magnitude while merging, then refined and sorted strongest first
+  SpectralPeak spectralPeaks[SPECTRAL_PEAKS_K] = {};
+  size_t spectralPeakCount = 0;
+
+  // Hop staging (incremental input). With the quiet gate the ring also holds
+  // the hops of the open frame's deferred windows.
+#if FFT_QUIET_GATE
+  static constexpr size_t stageSlots = Spec::hops + (FFT_QUIET_FRAME_SAMPLES + Spec::step - 1) / Spec::step;
+#else
+  static constexpr size_t stageSlots = Spec::hops;
+#endif
+  float* staged = nullptr;            // stageSlots calibrated hops, ring
+  float hopSums[stageSlots] = {};     // per-slot sums for the window mean
+  size_t stageHead = 0;               // next slot to write
+  size_t stagedHops = 0;              // valid hops since the last history reset
+  size_t frameWindows = 0;            // windows pooled into the open frame
+  HopLevel hopLevels[stageSlots] = {};
+  float levelDc = 0.0f;               // last hop mean (DC estimate for the next hop)
+  bool levelDcValid = false;
+  bool levelNegative = false;         // sign of the last sample about its DC
+
+  // Quiet gate state; the floor survives frames like baselineBandRMS
+  float quietFloor = 0.0f;            // asymmetric EMA of window RMS (V)
+  uint32_t gateWarmup = 0;            // windows seen before gating is allowed
+  float frameLevelSq = 0.0f;          // open frame: sum of window RMS^2
+  float frameZcrHz = 0.0f;            // open frame: sum of window ZCR
+  size_t frameLevelWindows = 0;       // open frame: windows measured
+  size_t deferredWindows = 0;         // open frame: quiet windows not transformed yet
+  size_t deferredSlot = 0;            // oldest hop slot of the first of them
+  bool frameQuiet = false;            // last closed frame was quiet
+  float lastLevelRMS = 0.0f;          // last closed frame's level
+  float lastZcrHz = 0.0f;
+  QuietGateStats gateStats = {};
+
+  Lane lanes[LANES] = {};
+#if FFT_BACKEND == FFT_BACKEND_REAL
+  RealFFTPlan fftPlan;                // read-only after init, shared by both lanes
+#endif
+#if FFT_PARALLEL
+  TaskHandle_t laneWorker = nullptr;
+  BaseType_t laneWorkerCore = tskNO_AFFINITY;
+  SemaphoreHandle_t laneStart = nullptr;
+  SemaphoreHandle_t laneDone = nullptr;
+  bool laneBusy = false;              // lane 1 handed to the worker, not yet collected
+  volatile bool laneStop = false;
+#endif
+
+  // Voice detection state
+  volatile bool fftReady = false;
+  FFTStatus fftStatus = FFTStatus::NOT_READY;
+  bool voiceDetected = false;
+  float voiceEnergy = 0.0f;
+  float noiseEnergy = 0.0f;
+  float snr = 0.0f;                   // RMS-based SNR (exported)
+  int   peakCount = 0;
+  float contrast = 0.0f;
+  float prevVoiceEnergy = 0.0f;
+  float sfm = 1.0f;                   // spectral flatness in voice band
+  float bandRMS = 0.0f;               // RMS magnitude in voice band
+  float noiseRMS = 0.0f;              // RMS magnitude outside band
+  float baselineBandRMS = 0.0f;       // EMA baseline of bandRMS (updated when no-voice)
+  float voiceIntensityDB = 0.0f;      // dB above baseline
+  uint8_t confirmCnt = 0;             // 2-frame confirmation
+  bool voiceState = false;            // debounced presence
+
+  // Profiling
+  FFTStageTimes stageTimes = {};      // input/features + dispatcher-side counts
+  FFTStageTimes stageTotals = {};     // stageTimes + lane times, built by getStageTimes()
+};
+
+using FFTEngine = FFTEngineT<DefaultFFTSpec>;
+extern template class FFTEngineT<DefaultFFTSpec>;
+FFTEngine& defaultFFTEngine();
+
+// === Lifecycle (C API below drives defaultFFTEngine()) ===
 bool initFFTEngine();       // Full initialization + PSRAM allocations
 void deinitFFTEngine();     // Free all resources
 void resetFFTEngine();      // ✅ Soft reset without realloc
 
-// === Processing ===
+// === Processing: whole capture, one frame per call ===
 bool processFFT(const float* mvSamples, size_t count);
+// Raw ADC codes straight in; rawToVolts has ADC_RAW_CODES entries (getRawToVoltsTable())
+bool processFFTRaw(const uint16_t* raw, size_t count, const float* rawToVolts);
+
+// === Processing: incremental, FFT_STEP_SIZE samples per push ===
+// A window runs as soon as FFT_SIZE / FFT_STEP_SIZE hops are staged, so features
+// are ready one FFT after the last hop. Pooling persists until finalizeFrame();
+// processFFT*() are beginFrame() + pushHop*() per hop + finalizeFrame().
+void beginFrame();                                          // drop pooled windows + hop history
+void resetHopHistory();                                     // discontinuity: next window needs fresh hops
+bool pushHop(const uint16_t* raw, const float* rawToVolts);
+bool pushHopMV(const float* mvSamples);
+bool finalizeFrame();                                       // features over pooled windows; sets fftReady
+size_t getFrameWindows();                                   // windows pooled into the open frame
 
 // === State ===
 bool isFFTReady();
 void resetFFTReady();
 FFTStatus getFFTStatus();
 
+// === Feature snapshot (values of the last finalized frame) ===
+FFTFeatures getFFTFeatures();
+
 // === Voice detection results ===
 bool isVoiceDetected();
 float getVoiceSNR();
@@ -41,5 +438,28 @@ size_t getFFTBins();
 
 // === Utility ===
 float getDominantFrequency(float& magnitudeOut);
+size_t getSpectralPeaks(SpectralPeak* out, size_t k);   // last finalized frame, strongest first
 float getVoiceIntensityDB();
 float getVoiceIntensityPct();
+
+// === Band levels (last finalized frame) ===
+const float* getFFTBandLevels();      // dB, THIRD_OCTAVE_BANDS entries
+const float* getFFTBandCenters();     // Hz
+float getFFTLAeq();                   // dB, A-weighted
+// A-weighted mean square (V^2) of each transformed window, oldest first, one
+// hop apart: the level meter's input. Up to FFT_WINDOW_LEVELS are held; older
+// ones are dropped when nobody drains.
+size_t drainFFTWindowLevels(float* out, size_t maxCount);
+
+// === Profiling (all zero unless FFT_ENGINE_PROFILE) ===
+const FFTStageTimes& getFFTStageTimes();
+void resetFFTStageTimes();
+
+// === Quiet gate counters ===
+const QuietGateStats& getQuietGateStats();
+
+#if FFT_PARALLEL
+// === Lane worker task ===
+void setFFTLaneWorkerCore(BaseType_t core);   // before initFFTEngine(); any core by default
+TaskHandle_t getFFTLaneWorker();              // run-time accounting
+#endif
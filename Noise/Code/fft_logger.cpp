@@ -1,12 +1,15 @@
 #include "fft_logger.h"
 #include <SD.h>
 #include <SPI.h>
+#include "sd_backend.h"
 #include <time.h>
 #include "signal_config.h"
 #include "esp_heap_caps.h"
 #include "fft_engine.h"
 #include <SdFat.h>
 #include <sdios.h>
+#include "esp_idf_version.h"
+#include "esp_vfs_fat.h"
 
 // NEW: require time sync
 #include "wifi_manager.h"   // isTimeSynced(), getFormattedTime()
@@ -15,9 +18,12 @@
 #define DEBUG_FFT_LOGGER true
 
 // === Config ===
+#ifndef MAX_LOG_FILE_SIZE
 #define MAX_LOG_FILE_SIZE (500UL * 1024UL * 1024UL) // 500 MB max per file
+#endif
 
 static bool sdReady = false;
+static const StorageBackend* storage = nullptr;   // mounted bus (sd_backend.h)
 static File logFile;
 static uint32_t logOffset = 0;
 static const char* indexFile = "/log_idx.txt";
@@ -29,6 +35,32 @@ static uint16_t logFileIndex = 0;
 static uint8_t sectorBuffer[512];
 static LoggerStatus loggerStatus = LoggerStatus::NOT_READY;
 
+// Write-behind ring (LOG_STAGING_ENABLED): file offsets [stageStart, logOffset)
+// are staged, everything before stageStart is on the card. A chunk flush ends
+// on a chunk boundary, usually inside a record: cardEnd is the end of the last
+// whole record on the card, the write pointer that LOGH and log_idx.txt keep.
+static uint8_t* stageBuffer = nullptr;
+static uint32_t stageStart = 0;
+static uint32_t cardEnd = 0;
+static uint32_t chunkRecordEnd = 0;  // last record boundary at or before the latest chunk boundary
+static uint32_t stageOldestMs = 0;
+static LoggerWriteStats writeStats = {};
+
+// Preallocated file (LOG_PREALLOCATE): records start after the LOGH sector
+static uint32_t logDataStart = 0;
+static uint32_t logHeaderEnd = 0;    // write pointer read back from LOGH when opened
+
+// Frame index sidecar (LOG_INDEX_EVERY): entries wait here until the record
+// they point at is on the card (offset < cardEnd)
+struct FrameIndexEntry {
+  uint64_t timestamp;
+  uint32_t offset;
+};
+#define LOG_INDEX_PENDING 32
+static FrameIndexEntry indexPending[LOG_INDEX_PENDING];
+static size_t indexPendingCount = 0;
+static uint32_t indexFrames = 0;     // frame records since the log file was opened
+
 // ===== Time sanity gate (prevents writing with stale/undefined RTC) =====
 static const time_t MIN_VALID_EPOCH = 1751328000; // 2025-07-31 00:00:00 UTC (pick any safe floor)
 
@@ -42,25 +74,25 @@ static inline bool timeIsSane() {
 
 // FIX: atomic (truncate) number write via temp+rename
 static inline void atomicWriteUL(const char* path, const char* tmpPath, unsigned long v) {
-  if (File t = SD.open(tmpPath, FILE_WRITE)) {
+  if (File t = storage->fs.open(tmpPath, FILE_WRITE)) {
     t.printf("%lu\n", v);
     t.close();
-    SD.remove(path);
-    SD.rename(tmpPath, path);
+    storage->fs.remove(path);
+    storage->fs.rename(tmpPath, path);
   }
 }
 static inline void atomicWriteU16(const char* path, const char* tmpPath, uint16_t v) {
-  if (File t = SD.open(tmpPath, FILE_WRITE)) {
+  if (File t = storage->fs.open(tmpPath, FILE_WRITE)) {
     t.printf("%u\n", v);
     t.close();
-    SD.remove(path);
-    SD.rename(tmpPath, path);
+    storage->fs.remove(path);
+    storage->fs.rename(tmpPath, path);
   }
 }
 
 // FIX: robust read of a single integer (returns false if not present/invalid)
 static bool readUL(const char* path, unsigned long& out) {
-  File f = SD.open(path, FILE_READ);
+  File f = storage->fs.open(path, FILE_READ);
   if (!f) return false;
   String s = f.readString(); // read all; avoids parseInt() stopping at first stale "0\n"
   f.close();
@@ -86,33 +118,173 @@ static bool readU16(const char* path, uint16_t& out) {
   return true;
 }
 
+// --- LOGH: sector 0 of a preallocated log file ---
+// magic, version u8, 3 reserved, file size u32, write pointer u32, timestamp u64
+static void writeLogHeader(File& f, uint32_t end) {
+  memset(sectorBuffer, 0, sizeof(sectorBuffer));
+  uint8_t* ptr = sectorBuffer;
+  memcpy(ptr, "LOGH", 4);                        ptr += 4;
+  uint8_t version = 1;                           memcpy(ptr, &version, sizeof(version)); ptr += sizeof(version);
+  ptr += 3;                                      // reserved
+  uint32_t size = MAX_LOG_FILE_SIZE;             memcpy(ptr, &size, sizeof(size)); ptr += sizeof(size);
+  memcpy(ptr, &end, sizeof(end));                ptr += sizeof(end);
+  uint64_t ts = (uint64_t)time(nullptr);         memcpy(ptr, &ts, sizeof(ts)); ptr += sizeof(ts);
+  f.seek(0);
+  f.write(sectorBuffer, sizeof(sectorBuffer));
+}
+
+// --- LOG_XXXX.IDX: frame index sidecar of LOG_XXXX.BIN ---
+// "LIDX" header: magic, version u8, reserved u8, LOG_INDEX_EVERY u16, 8 reserved
+// entries: frame timestamp u64, record offset u32, 4 reserved
+static void noteFrameRecord(uint64_t timestamp) {
+#if LOG_INDEX_EVERY > 0
+  if (indexFrames++ % LOG_INDEX_EVERY == 0 && indexPendingCount < LOG_INDEX_PENDING) {
+    indexPending[indexPendingCount++] = { timestamp, logOffset };
+  }
+#else
+  (void)timestamp;
+#endif
+}
+
+static void appendFrameIndex() {
+  size_t n = 0;
+  while (n < indexPendingCount && indexPending[n].offset < cardEnd) n++;
+  if (n == 0) return;
+
+  char fname[32];
+  snprintf(fname, sizeof(fname), "/LOG_%04u.IDX", logFileIndex);
+  File f = storage->fs.open(fname, FILE_APPEND);
+  if (!f) return;   // kept pending; dropped once the queue is full
+
+  memset(sectorBuffer, 0, sizeof(sectorBuffer));
+  size_t used = 0;
+  if (f.size() == 0) {
+    memcpy(sectorBuffer, "LIDX", 4);
+    sectorBuffer[4] = 1;                           // version
+    uint16_t every = LOG_INDEX_EVERY;              memcpy(sectorBuffer + 6, &every, sizeof(every));
+    used = 16;
+  }
+  for (size_t i = 0; i < n; ++i) {
+    if (used == sizeof(sectorBuffer)) {
+      f.write(sectorBuffer, used);
+      memset(sectorBuffer, 0, sizeof(sectorBuffer));
+      used = 0;
+    }
+    memcpy(sectorBuffer + used, &indexPending[i].timestamp, sizeof(uint64_t));
+    memcpy(sectorBuffer + used + 8, &indexPending[i].offset, sizeof(uint32_t));
+    used += 16;
+  }
+  f.write(sectorBuffer, used);
+  f.close();
+
+  memmove(indexPending, indexPending + n, (indexPendingCount - n) * sizeof(FrameIndexEntry));
+  indexPendingCount -= n;
+}
+
 // --- Small helper: persist current index state ---
 // FIX: make writes atomic and truncating
+// Only whole records on the card count: not staged ones, nor the head of one
+// that a chunk flush split
 static inline void persistIndices() {
-  atomicWriteUL(indexFile, "/log_idx.tmp", (unsigned long)logOffset);
+  if (logDataStart && logFile) writeLogHeader(logFile, cardEnd);
+  atomicWriteUL(indexFile, "/log_idx.tmp", (unsigned long)cardEnd);
   atomicWriteU16(fileIndexFile, "/log_file_idx.tmp", logFileIndex);
+  appendFrameIndex();
+  writeStats.indexUpdates++;
+}
+
+#if LOG_PREALLOCATE
+static bool readLogHeader(File& f, uint32_t& end) {
+  if (f.size() < sizeof(sectorBuffer)) return false;
+  f.seek(0);
+  if (f.read(sectorBuffer, sizeof(sectorBuffer)) != (int)sizeof(sectorBuffer)) return false;
+  if (memcmp(sectorBuffer, "LOGH", 4) != 0) return false;
+  memcpy(&end, sectorBuffer + 12, sizeof(end));
+  return end >= sizeof(sectorBuffer) && end <= MAX_LOG_FILE_SIZE;
+}
+
+// Create the file at MAX_LOG_FILE_SIZE in one allocation (contiguous with
+// IDF >= 5.2, else however FATFS extends it) and write its LOGH sector
+static bool preallocateLogFile(const char* fname) {
+  uint32_t t0 = millis();
+  char path[40];
+  snprintf(path, sizeof(path), "%s%s", storage->mountPoint, fname);
+  bool contiguous = false;
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 2, 0)
+  if (esp_vfs_fat_create_contiguous_file(storage->mountPoint, path, MAX_LOG_FILE_SIZE, true) != ESP_OK) return false;
+  esp_vfs_fat_test_contiguous_file(storage->mountPoint, path, &contiguous);
+  File f = storage->fs.open(fname, "r+");
+#else
+  File f = storage->fs.open(fname, FILE_WRITE);
+  if (f) {
+    memset(sectorBuffer, 0, sizeof(sectorBuffer));
+    f.seek(MAX_LOG_FILE_SIZE - sizeof(sectorBuffer));
+    f.write(sectorBuffer, sizeof(sectorBuffer));
+  }
+#endif
+  if (!f) return false;
+  writeLogHeader(f, sizeof(sectorBuffer));
+  f.close();
+#if DEBUG_FFT_LOGGER
+  Serial.printf("[SD] Preallocated %s: %lu MB%s in %lu ms\n", fname,
+                (unsigned long)(MAX_LOG_FILE_SIZE >> 20), contiguous ? " contiguous" : "",
+                (unsigned long)(millis() - t0));
+#else
+  (void)t0;
+  (void)contiguous;
+#endif
+  return true;
 }
+#endif
 
 // === Internal helper to open log file with rolling index ===
+// Sets logDataStart / logHeaderEnd for preallocated files
 static bool openLogFile() {
   char fname[32];
   snprintf(fname, sizeof(fname), "/LOG_%04u.BIN", logFileIndex);
-  // NOTE: FILE_WRITE creates if missing and appends; we will seek() after reconciling offset.
-  logFile = SD.open(fname, FILE_WRITE);
+  logDataStart = 0;
+  logHeaderEnd = 0;
+  indexPendingCount = 0;
+  indexFrames = 0;
+  const bool fresh = !storage->fs.exists(fname);
+  if (fresh) {
+    char idxName[32];
+    snprintf(idxName, sizeof(idxName), "/LOG_%04u.IDX", logFileIndex);
+    storage->fs.remove(idxName);   // sidecar left over from a deleted log file
+  }
+#if LOG_PREALLOCATE
+  if (fresh && !preallocateLogFile(fname)) {
+    Serial.printf("[SD] Preallocation of %s failed — appending instead\n", fname);
+    storage->fs.remove(fname);     // whatever the attempt left holds no records
+  }
+#endif
+  // An existing file is written in place through "r+" at the reconciled offset
+  // (FILE_WRITE truncates it, FILE_APPEND ignores seek()); only a file that
+  // does not exist yet is created with FILE_WRITE
+  if (storage->fs.exists(fname)) {
+    logFile = storage->fs.open(fname, "r+");
+  } else {
+    logFile = storage->fs.open(fname, FILE_WRITE);
+  }
+#if LOG_PREALLOCATE
+  if (logFile && readLogHeader(logFile, logHeaderEnd)) {
+    logDataStart = sizeof(sectorBuffer);
+  }
+#endif
   if (!logFile) {
     Serial.printf("[SD] Failed to open log file %s\n", fname);
     loggerStatus = LoggerStatus::FILE_OPEN_FAILED;
     return false;
   }
 #if DEBUG_FFT_LOGGER
-  Serial.printf("[SD] Opened log file: %s\n", fname);
+  Serial.printf("[SD] Opened log file: %s%s\n", fname, logDataStart ? " (preallocated)" : "");
 #endif
   return true;
 }
 
 // NEW: discover highest existing /LOG_XXXX.BIN and its size
 static bool findHighestLogFile(uint16_t& outIndex, uint32_t& outSize) {
-  File root = SD.open("/");
+  File root = storage->fs.open("/");
   if (!root) return false;
 
   bool found = false;
@@ -143,35 +315,43 @@ static bool findHighestLogFile(uint16_t& outIndex, uint32_t& outSize) {
 static bool getLogFileSizeIfExists(uint16_t idx, uint32_t& outSize) {
   char fname[32];
   snprintf(fname, sizeof(fname), "/LOG_%04u.BIN", idx);
-  File f = SD.open(fname, FILE_READ);
+  File f = storage->fs.open(fname, FILE_READ);
   if (!f) return false;
   outSize = f.size();
   f.close();
   return true;
 }
 
+static bool flushStage(bool all);
+
 void deinitFFTLogger() {
   if (logFile) {
+    // Staged records go out unless the card just failed a write
+    if (sdReady && loggerStatus != LoggerStatus::WRITE_FAILED) {
+      flushFFTLogger(true);
+      persistIndices();   // per-record writes persist every 10th; pending frame index entries
+    }
     logFile.flush();
     logFile.close();
   }
   sdReady = false;
   logOffset = 0;
+  stageStart = 0;
+  cardEnd = 0;
 
   if (logBuffer) {
     free(logBuffer);
     logBuffer = nullptr;
     logBufferSize = 0;
   }
+  if (stageBuffer) {
+    free(stageBuffer);
+    stageBuffer = nullptr;
+  }
 
   // --- fully release the bus so hot-insert works reliably ---
-  pinMode(SD_CS, OUTPUT);
-  digitalWrite(SD_CS, HIGH);     // deselect card
-  pinMode(SD_MOSI, INPUT);
-  pinMode(SD_SCK,  INPUT);
-  pinMode(SD_MISO, INPUT);
-  SD.end();
-  SPI.end();
+  if (storage) storage->end();
+  storage = nullptr;
   delay(50);
 
   loggerStatus = LoggerStatus::NOT_READY;
@@ -185,12 +365,10 @@ bool recoverFFTLogger() {
 bool initFFTLogger() {
   if (sdReady) return true;
 
-  SPI.begin(SD_SCK, SD_MISO, SD_MOSI, SD_CS);
   Serial.println("[SD] Initializing card...");
-  delay(100);
 
   for (int i = 0; i < 3; ++i) {
-    if (SD.begin(SD_CS, SPI, 25000000)) {
+    if ((storage = mountStorage())) {
       sdReady = true;
 
       // Allocate persistent buffer for maximum possible frame size
@@ -202,8 +380,14 @@ bool initFFTLogger() {
         loggerStatus = LoggerStatus::BUFFER_ALLOC_FAILED;
         return false;
       }
+#if LOG_STAGING_ENABLED
+      stageBuffer = (uint8_t*)heap_caps_malloc(LOG_STAGE_BYTES, MALLOC_CAP_SPIRAM);
+      if (!stageBuffer) {
+        Serial.println("[SD] No PSRAM for the staging ring — writing per record");
+      }
+#endif
 
-      uint8_t type = SD.cardType();
+      uint8_t type = storage->cardType();
       Serial.print("[SD] Card type: ");
       switch (type) {
         case CARD_NONE:
@@ -217,10 +401,12 @@ bool initFFTLogger() {
         default:         Serial.println("Unknown"); break;
       }
 
-      Serial.printf("[SD] Card size: %.2f MB\n", SD.cardSize() / (1024.0 * 1024.0));
+      Serial.printf("[SD] Card size: %.2f MB (%s)\n", storage->cardSize() / (1024.0 * 1024.0), storage->name);
 
       // ===== Read stored indices if available (non-fatal if missing) =====
-      bool haveIdx  = readUL(indexFile, (unsigned long&)logOffset);
+      unsigned long storedOffset = 0;
+      bool haveIdx  = readUL(indexFile, storedOffset);
+      if (haveIdx) logOffset = (uint32_t)storedOffset;
       bool haveFidx = readU16(fileIndexFile, logFileIndex);
 
       // NEW: If file index is missing/stale, discover highest existing file & treat EOF as authoritative
@@ -260,10 +446,15 @@ bool initFFTLogger() {
       if (!openLogFile()) return false;
 
       // ===== Reconcile against actual file size (APPEND-SAFE) =====
-      uint32_t sz = logFile.size();
+      // (preallocated: the LOGH write pointer stands in for the size)
+      uint32_t sz = logDataStart ? logHeaderEnd : logFile.size();
 
       // FIX: never rewind; if indices missing/stale or don't match, APPEND to end
-      if (!haveIdx || logOffset != sz) {
+      // Exception: the staging ring persists the end of its last whole record,
+      // so bytes past it are the head of a record a chunk flush split
+      if (stageBuffer && haveIdx && haveFidx && logOffset < sz) {
+        // resume at the index, over the split record
+      } else if (!haveIdx || logOffset != sz) {
         if (logOffset > sz) {
           // stale index beyond EOF -> clamp
           logOffset = sz;
@@ -278,6 +469,7 @@ bool initFFTLogger() {
 
       // Seek to reconciled position
       logFile.seek(logOffset);
+      stageStart = cardEnd = logOffset;
 
 #if DEBUG_FFT_LOGGER
       {
@@ -304,8 +496,15 @@ bool initFFTLogger() {
   return false;
 }
 
-bool saveFFTFrame(const float* frequencies, const float* magnitudes, size_t count) {
-  if (!sdReady || !logFile || !frequencies || !magnitudes || count == 0) {
+// === Record framing (every record type) ===
+// Readiness and time gate, rollover, then a zeroed sector-aligned record of
+// alignedSize bytes at logBuffer for the caller to fill.
+#if FFT_LOG_RECORD == FFT_LOG_COMPACT
+static bool writeGridRecord();
+#endif
+
+static bool beginRecord(size_t rawSize, size_t& alignedSize) {
+  if (!sdReady || !logFile) {
 #if DEBUG_FFT_LOGGER
     Serial.println("[SD] Not ready — skipping FFT save.");
 #endif
@@ -322,25 +521,29 @@ bool saveFFTFrame(const float* frequencies, const float* magnitudes, size_t coun
     goto logger_fail;
   }
 
-  const size_t headerSize = 32;
-  const size_t dataSize = count * sizeof(float) * 2;
-  const size_t rawSize = headerSize + dataSize;
-  const size_t alignedSize = ((rawSize + 511) / 512) * 512;
+  alignedSize = ((rawSize + 511) / 512) * 512;
 
   if (logOffset + alignedSize > MAX_LOG_FILE_SIZE) {
 #if DEBUG_FFT_LOGGER
     Serial.println("[SD] Rollover: opening new log file");
 #endif
+    if (!flushStage(true)) return false;
+    persistIndices();   // final write pointer and frame index of the full file
     logFile.close();
     logFileIndex++;
-    logOffset = 0;
     if (!openLogFile()) return false;
+    logOffset = stageStart = cardEnd = logDataStart;
 
     // Persist indices immediately so a reboot continues on the new file
     persistIndices();
     logFile.flush();
   }
 
+#if FFT_LOG_RECORD == FFT_LOG_COMPACT
+  // FFT3 frames carry no frequencies: every log file starts with the grid
+  if (logOffset == logDataStart && !writeGridRecord()) return false;
+#endif
+
   if (alignedSize > logBufferSize) {
     Serial.println("[SD] Log buffer too small for frame");
     loggerStatus = LoggerStatus::BUFFER_ALLOC_FAILED;
@@ -348,45 +551,81 @@ bool saveFFTFrame(const float* frequencies, const float* magnitudes, size_t coun
   }
 
   memset(logBuffer, 0, alignedSize);
-  uint8_t* ptr = logBuffer;
-
-  memcpy(ptr, "FFT2", 4);                        ptr += 4;
-  uint64_t ts = (uint64_t)time(nullptr);         memcpy(ptr, &ts, sizeof(ts)); ptr += sizeof(ts);
-  uint8_t voice = isVoiceDetected() ? 1 : 0;     memcpy(ptr, &voice, sizeof(voice)); ptr += sizeof(voice);
-  float snr = getVoiceSNR();                     memcpy(ptr, &snr, sizeof(snr)); ptr += sizeof(snr);
-  float energy = getVoiceEnergy();               memcpy(ptr, &energy, sizeof(energy)); ptr += sizeof(energy);
-  uint16_t peaks = getVoicePeakCount();          memcpy(ptr, &peaks, sizeof(peaks)); ptr += sizeof(peaks);
-  float contrast = getVoiceContrast();           memcpy(ptr, &contrast, sizeof(contrast)); ptr += sizeof(contrast);
-  uint16_t bins = count;                         memcpy(ptr, &bins, sizeof(bins)); ptr += sizeof(bins);
-  uint8_t reserved[3] = {0};                     memcpy(ptr, reserved, sizeof(reserved)); ptr += sizeof(reserved);
-
-  for (size_t i = 0; i < count; ++i) {
-    memcpy(ptr, &frequencies[i], sizeof(float)); ptr += sizeof(float);
-    memcpy(ptr, &magnitudes[i], sizeof(float));  ptr += sizeof(float);
-  }
+  return true;
+}
 
-  logFile.seek(logOffset);
-  uint32_t t0 = millis();
-  size_t written = logFile.write(logBuffer, alignedSize);
-  uint32_t t1 = millis();
+// One timed write() at a file offset
+static bool writeAt(uint32_t offset, const uint8_t* data, size_t size) {
+  logFile.seek(offset);
+  uint32_t t0 = micros();
+  size_t written = logFile.write(data, size);
+  uint32_t us = micros() - t0;
 
-  if (written != alignedSize) {
-    Serial.printf("[SD] Write error: %u of %u\n", (unsigned)written, (unsigned)alignedSize);
+  if (written != size) {
+    Serial.printf("[SD] Write error: %u of %u\n", (unsigned)written, (unsigned)size);
     loggerStatus = LoggerStatus::WRITE_FAILED;
     return false;
   }
 
-  logOffset += alignedSize;
-
+  writeStats.writes++;
+  writeStats.bytes += size;
+  writeStats.writeUs += us;
+  if (us > writeStats.maxWriteUs) writeStats.maxWriteUs = us;
 #if DEBUG_FFT_LOGGER
-  if ((t1 - t0) > 100) {
-    Serial.printf("[SD] Warning: write took %lu ms\n", t1 - t0);
+  if (us > 100000) {
+    Serial.printf("[SD] Warning: write took %lu ms\n", (unsigned long)(us / 1000));
   }
-  Serial.printf("[SD] voice=%d, SNR=%.2f, energy=%.1f, peaks=%u, contrast=%.2f\n",
-                voice, snr, energy, peaks, contrast);
-  Serial.printf("[SD] Wrote FFT frame (%u bins, %u bytes)\n",
-                (unsigned)count, (unsigned)alignedSize);
 #endif
+  return true;
+}
+
+// Write staged records: whole chunks up to the last chunk boundary, or
+// everything (all). A chunk never wraps the ring (LOG_STAGE_BYTES is a
+// multiple of LOG_FLUSH_CHUNK), so each is one write.
+static bool flushStage(bool all) {
+  if (!stageBuffer) return true;
+  const uint32_t end = all ? logOffset : (logOffset / LOG_FLUSH_CHUNK) * LOG_FLUSH_CHUNK;
+  if (end <= stageStart) return true;
+
+  while (stageStart < end) {
+    const uint32_t next = std::min<uint32_t>(end, (stageStart / LOG_FLUSH_CHUNK + 1) * LOG_FLUSH_CHUNK);
+    if (!writeAt(stageStart, stageBuffer + stageStart % LOG_STAGE_BYTES, next - stageStart)) return false;
+    stageStart = next;
+  }
+  cardEnd = all ? logOffset : chunkRecordEnd;
+  stageOldestMs = millis();   // the remainder (under one chunk) is recent: restart its age
+
+  persistIndices();
+  logFile.flush();
+  loggerStatus = LoggerStatus::OK;
+  return true;
+}
+
+// Stage the record built by beginRecord() (or write it, without the ring) and
+// advance the log
+static bool commitRecord(size_t alignedSize) {
+  if (stageBuffer) {
+    if (logOffset + alignedSize - stageStart > LOG_STAGE_BYTES && !flushStage(true)) return false;
+    if (logOffset == stageStart) stageOldestMs = millis();
+    const size_t pos = logOffset % LOG_STAGE_BYTES;
+    const size_t first = std::min<size_t>(alignedSize, LOG_STAGE_BYTES - pos);
+    memcpy(stageBuffer + pos, logBuffer, first);
+    memcpy(stageBuffer, logBuffer + first, alignedSize - first);
+    const uint32_t start = logOffset;
+    logOffset += alignedSize;
+    if (start / LOG_FLUSH_CHUNK != logOffset / LOG_FLUSH_CHUNK) {
+      chunkRecordEnd = (logOffset % LOG_FLUSH_CHUNK == 0) ? logOffset : start;
+    }
+
+    if (millis() - stageOldestMs >= LOG_FLUSH_AGE_MS) return flushStage(true);
+    if (logOffset - stageStart >= LOG_FLUSH_CHUNK) return flushStage(false);
+    loggerStatus = LoggerStatus::OK;
+    return true;
+  }
+
+  if (!writeAt(logOffset, logBuffer, alignedSize)) return false;
+  logOffset += alignedSize;
+  stageStart = cardEnd = logOffset;
 
   static uint16_t counter = 0;
   if (++counter >= 10) {
@@ -399,6 +638,284 @@ bool saveFFTFrame(const float* frequencies, const float* magnitudes, size_t coun
   return true;
 }
 
+bool saveFFTFrame(const float* frequencies, const float* magnitudes, size_t count,
+                  const FFTFeatures& features, uint64_t timestamp) {
+  // Quiet frames (every window gated) carry level statistics only
+  const bool quiet = features.quiet;
+  if (!quiet && (!frequencies || !magnitudes || count == 0)) {
+    loggerStatus = LoggerStatus::NOT_READY;
+    return false;
+  }
+
+  const size_t headerSize = 32;
+  const size_t dataSize = quiet ? 0 : count * sizeof(float) * 2;
+  size_t alignedSize = 0;
+  if (!beginRecord(headerSize + dataSize, alignedSize)) return false;
+  noteFrameRecord(timestamp);
+  uint8_t* ptr = logBuffer;
+
+  if (quiet) {
+    // "FFTQ": one sector instead of a full spectrum frame
+    memcpy(ptr, "FFTQ", 4);                      ptr += 4;
+    uint64_t ts = timestamp;                     memcpy(ptr, &ts, sizeof(ts)); ptr += sizeof(ts);
+    float levelRMS = features.levelRMS;          memcpy(ptr, &levelRMS, sizeof(levelRMS)); ptr += sizeof(levelRMS);
+    float zcrHz = features.zcrHz;                memcpy(ptr, &zcrHz, sizeof(zcrHz)); ptr += sizeof(zcrHz);
+    float noiseFloor = features.noiseFloor;      memcpy(ptr, &noiseFloor, sizeof(noiseFloor)); ptr += sizeof(noiseFloor);
+    // 8 reserved bytes (zero) complete the 32-byte header
+  } else {
+    memcpy(ptr, "FFT2", 4);                        ptr += 4;
+    uint64_t ts = timestamp;                       memcpy(ptr, &ts, sizeof(ts)); ptr += sizeof(ts);
+    uint8_t voice = features.voice ? 1 : 0;        memcpy(ptr, &voice, sizeof(voice)); ptr += sizeof(voice);
+    float snr = features.snr;                      memcpy(ptr, &snr, sizeof(snr)); ptr += sizeof(snr);
+    float energy = features.energy;                memcpy(ptr, &energy, sizeof(energy)); ptr += sizeof(energy);
+    uint16_t peaks = features.peakCount;           memcpy(ptr, &peaks, sizeof(peaks)); ptr += sizeof(peaks);
+    float contrast = features.contrast;            memcpy(ptr, &contrast, sizeof(contrast)); ptr += sizeof(contrast);
+    uint16_t bins = count;                         memcpy(ptr, &bins, sizeof(bins)); ptr += sizeof(bins);
+    uint8_t reserved[3] = { FFT_POOL_POLICY, 0, 0 }; memcpy(ptr, reserved, sizeof(reserved)); ptr += sizeof(reserved);  // [0] = pooling policy
+
+    for (size_t i = 0; i < count; ++i) {
+      memcpy(ptr, &frequencies[i], sizeof(float)); ptr += sizeof(float);
+      memcpy(ptr, &magnitudes[i], sizeof(float));  ptr += sizeof(float);
+    }
+  }
+
+  if (!commitRecord(alignedSize)) return false;
+
+#if DEBUG_FFT_LOGGER
+  if (quiet) {
+    Serial.printf("[SD] Wrote quiet frame (RMS=%.2f mV, ZCR=%.0f Hz, %u bytes)\n",
+                  features.levelRMS * 1000.0f, features.zcrHz, (unsigned)alignedSize);
+  } else {
+    Serial.printf("[SD] voice=%d, SNR=%.2f, energy=%.1f, peaks=%d, contrast=%.2f\n",
+                  features.voice ? 1 : 0, features.snr, features.energy, features.peakCount, features.contrast);
+    Serial.printf("[SD] Wrote FFT frame (%u bins, %u bytes)\n",
+                  (unsigned)count, (unsigned)alignedSize);
+  }
+#endif
+  return true;
+}
+
+#if FFT_LOG_RECORD == FFT_LOG_COMPACT
+// "FGRD": the engine's frequency grid and config, first record of each file
+static bool writeGridRecord() {
+  const float* frequencies = getFFTFrequencies();
+  const size_t bins = getFFTBins();
+  const size_t alignedSize = ((32 + bins * sizeof(float) + 511) / 512) * 512;
+  if (!frequencies || alignedSize > logBufferSize) {
+    loggerStatus = LoggerStatus::BUFFER_ALLOC_FAILED;
+    return false;
+  }
+  memset(logBuffer, 0, alignedSize);
+  uint8_t* ptr = logBuffer;
+
+  memcpy(ptr, "FGRD", 4);                        ptr += 4;
+  uint64_t ts = (uint64_t)time(nullptr);         memcpy(ptr, &ts, sizeof(ts)); ptr += sizeof(ts);
+  uint8_t version = 1;                           memcpy(ptr, &version, sizeof(version)); ptr += sizeof(version);
+  uint8_t policy = FFT_POOL_POLICY;              memcpy(ptr, &policy, sizeof(policy)); ptr += sizeof(policy);
+  uint16_t count = bins;                         memcpy(ptr, &count, sizeof(count)); ptr += sizeof(count);
+  uint32_t sampleRate = SAMPLE_RATE;             memcpy(ptr, &sampleRate, sizeof(sampleRate)); ptr += sizeof(sampleRate);
+  uint16_t fftSize = FFT_SIZE;                   memcpy(ptr, &fftSize, sizeof(fftSize)); ptr += sizeof(fftSize);
+  uint16_t stepSize = FFT_STEP_SIZE;             memcpy(ptr, &stepSize, sizeof(stepSize)); ptr += sizeof(stepSize);
+  ptr = logBuffer + 32;                          // reserved (zero) completes the 32-byte header
+  memcpy(ptr, frequencies, bins * sizeof(float));
+
+#if DEBUG_FFT_LOGGER
+  Serial.printf("[SD] Writing frequency grid (%u bins) at start of LOG_%04u.BIN\n",
+                (unsigned)bins, (unsigned)logFileIndex);
+#endif
+  return commitRecord(alignedSize);
+}
+
+bool saveCompactFrame(const float* magnitudes, size_t count, const FFTFeatures& features, uint64_t timestamp) {
+  if (features.quiet) return saveFFTFrame(nullptr, nullptr, 0, features, timestamp);
+  if (!magnitudes || count == 0 || count > 0xFFFF) {
+    loggerStatus = LoggerStatus::NOT_READY;
+    return false;
+  }
+
+  const size_t headerSize = 64;
+  const uint8_t encoding = FFT3_ENCODING;
+  size_t alignedSize = 0;
+  if (!beginRecord(headerSize + encodedSpectrumBytes(count, encoding), alignedSize)) return false;
+  noteFrameRecord(timestamp);
+  uint8_t* ptr = logBuffer;
+  const float scale = encodeSpectrum(magnitudes, count, encoding, logBuffer + headerSize);
+
+  memcpy(ptr, "FFT3", 4);                        ptr += 4;
+  uint64_t ts = timestamp;                       memcpy(ptr, &ts, sizeof(ts)); ptr += sizeof(ts);
+  uint8_t version = 1;                           memcpy(ptr, &version, sizeof(version)); ptr += sizeof(version);
+  memcpy(ptr, &encoding, sizeof(encoding));      ptr += sizeof(encoding);
+  uint8_t policy = FFT_POOL_POLICY;              memcpy(ptr, &policy, sizeof(policy)); ptr += sizeof(policy);
+  uint8_t voice = features.voice ? 1 : 0;        memcpy(ptr, &voice, sizeof(voice)); ptr += sizeof(voice);
+  uint16_t bins = count;                         memcpy(ptr, &bins, sizeof(bins)); ptr += sizeof(bins);
+  uint16_t peaks = features.peakCount;           memcpy(ptr, &peaks, sizeof(peaks)); ptr += sizeof(peaks);
+  float snr = features.snr;                      memcpy(ptr, &snr, sizeof(snr)); ptr += sizeof(snr);
+  float energy = features.energy;                memcpy(ptr, &energy, sizeof(energy)); ptr += sizeof(energy);
+  float contrast = features.contrast;            memcpy(ptr, &contrast, sizeof(contrast)); ptr += sizeof(contrast);
+  memcpy(ptr, &scale, sizeof(scale));            ptr += sizeof(scale);
+  float step = encoding == FFT3_ENC_LOG8 ? FFT3_LOG8_STEP_DB : 0.0f;
+  memcpy(ptr, &step, sizeof(step));              ptr += sizeof(step);
+  uint32_t sampleRate = SAMPLE_RATE;             memcpy(ptr, &sampleRate, sizeof(sampleRate)); ptr += sizeof(sampleRate);
+  uint16_t fftSize = FFT_SIZE;                   memcpy(ptr, &fftSize, sizeof(fftSize)); ptr += sizeof(fftSize);
+  uint16_t stepSize = FFT_STEP_SIZE;             memcpy(ptr, &stepSize, sizeof(stepSize)); ptr += sizeof(stepSize);
+  float intensity = features.intensityDB;        memcpy(ptr, &intensity, sizeof(intensity)); ptr += sizeof(intensity);
+  float laeq = features.laeqDB;                  memcpy(ptr, &laeq, sizeof(laeq)); ptr += sizeof(laeq);
+  float sfm = features.sfm;                      memcpy(ptr, &sfm, sizeof(sfm)); ptr += sizeof(sfm);
+  // 4 reserved bytes (zero) complete the 64-byte header
+
+  if (!commitRecord(alignedSize)) return false;
+
+#if DEBUG_FFT_LOGGER
+  Serial.printf("[SD] voice=%d, SNR=%.2f, energy=%.1f, peaks=%d, contrast=%.2f\n",
+                voice, snr, energy, features.peakCount, contrast);
+  Serial.printf("[SD] Wrote FFT3 frame (%u bins, %s, %u bytes)\n",
+                (unsigned)count, encoding == FFT3_ENC_F16 ? "f16" : "log8", (unsigned)alignedSize);
+#endif
+  return true;
+}
+#endif
+
+bool saveBandFrame(const float* bandLevels, size_t bands, const FFTFeatures& features, uint64_t timestamp) {
+  if (features.quiet) return saveFFTFrame(nullptr, nullptr, 0, features, timestamp);
+  if (!bandLevels || bands == 0 || bands > 255) {
+    loggerStatus = LoggerStatus::NOT_READY;
+    return false;
+  }
+
+  const size_t headerSize = 32;
+  size_t alignedSize = 0;
+  if (!beginRecord(headerSize + bands * sizeof(float), alignedSize)) return false;
+  noteFrameRecord(timestamp);
+  uint8_t* ptr = logBuffer;
+
+  memcpy(ptr, "FFTB", 4);                        ptr += 4;
+  uint64_t ts = timestamp;                       memcpy(ptr, &ts, sizeof(ts)); ptr += sizeof(ts);
+  uint8_t voice = features.voice ? 1 : 0;        memcpy(ptr, &voice, sizeof(voice)); ptr += sizeof(voice);
+  uint8_t policy = FFT_POOL_POLICY;              memcpy(ptr, &policy, sizeof(policy)); ptr += sizeof(policy);
+  uint8_t count = bands;                         memcpy(ptr, &count, sizeof(count)); ptr += sizeof(count);
+  int8_t firstBand = THIRD_OCTAVE_FIRST;         memcpy(ptr, &firstBand, sizeof(firstBand)); ptr += sizeof(firstBand);
+  float laeq = features.laeqDB;                  memcpy(ptr, &laeq, sizeof(laeq)); ptr += sizeof(laeq);
+  float snr = features.snr;                      memcpy(ptr, &snr, sizeof(snr)); ptr += sizeof(snr);
+  float intensity = features.intensityDB;        memcpy(ptr, &intensity, sizeof(intensity)); ptr += sizeof(intensity);
+  ptr += 4;                                      // reserved (zero) completes the 32-byte header
+  memcpy(ptr, bandLevels, bands * sizeof(float));
+
+  if (!commitRecord(alignedSize)) return false;
+
+#if DEBUG_FFT_LOGGER
+  Serial.printf("[SD] Wrote band frame (LAeq=%.1f dB, voice=%d, %u bands, %u bytes)\n",
+                laeq, voice, (unsigned)bands, (unsigned)alignedSize);
+#endif
+  return true;
+}
+
+bool saveLevelSeconds(const LevelSecond* seconds, size_t count) {
+  if (!seconds || count == 0 || count > 255) {
+    loggerStatus = LoggerStatus::NOT_READY;
+    return false;
+  }
+
+  const size_t headerSize = 32, entrySize = 32;
+  size_t alignedSize = 0;
+  if (!beginRecord(headerSize + count * entrySize, alignedSize)) return false;
+  uint8_t* ptr = logBuffer;
+
+  memcpy(ptr, "LVL1", 4);                        ptr += 4;
+  uint8_t n = count;                             memcpy(ptr, &n, sizeof(n)); ptr += sizeof(n);
+  ptr += 3;                                      // reserved
+  float fastTau = LEVEL_FAST_TAU_S;              memcpy(ptr, &fastTau, sizeof(fastTau)); ptr += sizeof(fastTau);
+  float slowTau = LEVEL_SLOW_TAU_S;              memcpy(ptr, &slowTau, sizeof(slowTau)); ptr += sizeof(slowTau);
+  ptr += 16;                                     // reserved (zero) completes the 32-byte header
+
+  for (size_t i = 0; i < count; ++i) {
+    const LevelSecond& s = seconds[i];
+    memcpy(ptr, &s.timestamp, sizeof(s.timestamp)); ptr += sizeof(s.timestamp);
+    memcpy(ptr, &s.laeq, sizeof(s.laeq));           ptr += sizeof(s.laeq);
+    memcpy(ptr, &s.lafMax, sizeof(s.lafMax));       ptr += sizeof(s.lafMax);
+    memcpy(ptr, &s.lafMin, sizeof(s.lafMin));       ptr += sizeof(s.lafMin);
+    memcpy(ptr, &s.lasMax, sizeof(s.lasMax));       ptr += sizeof(s.lasMax);
+    memcpy(ptr, &s.lasMin, sizeof(s.lasMin));       ptr += sizeof(s.lasMin);
+    memcpy(ptr, &s.samples, sizeof(s.samples));     ptr += sizeof(s.samples);
+  }
+
+  if (!commitRecord(alignedSize)) return false;
+
+#if DEBUG_FFT_LOGGER
+  Serial.printf("[SD] Wrote %u level seconds (last LAeq=%.1f dB, %u bytes)\n",
+                (unsigned)count, seconds[count - 1].laeq, (unsigned)alignedSize);
+#endif
+  return true;
+}
+
+bool saveLevelSummary(const LevelSummary& s) {
+  size_t alignedSize = 0;
+  if (!beginRecord(48, alignedSize)) return false;
+  uint8_t* ptr = logBuffer;
+
+  memcpy(ptr, "LSUM", 4);                        ptr += 4;
+  memcpy(ptr, &s.start, sizeof(s.start));        ptr += sizeof(s.start);
+  uint8_t period = (uint8_t)s.period;            memcpy(ptr, &period, sizeof(period)); ptr += sizeof(period);
+  ptr += 3;                                      // reserved
+  memcpy(ptr, &s.count, sizeof(s.count));        ptr += sizeof(s.count);
+  memcpy(ptr, &s.l10, sizeof(s.l10));            ptr += sizeof(s.l10);
+  memcpy(ptr, &s.l50, sizeof(s.l50));            ptr += sizeof(s.l50);
+  memcpy(ptr, &s.l90, sizeof(s.l90));            ptr += sizeof(s.l90);
+  memcpy(ptr, &s.leq, sizeof(s.leq));            ptr += sizeof(s.leq);
+  memcpy(ptr, &s.lmin, sizeof(s.lmin));          ptr += sizeof(s.lmin);
+  memcpy(ptr, &s.lmax, sizeof(s.lmax));          ptr += sizeof(s.lmax);
+  // 4 reserved bytes (zero) complete the 48-byte record
+
+  if (!commitRecord(alignedSize)) return false;
+
+#if DEBUG_FFT_LOGGER
+  Serial.printf("[SD] Wrote %s summary (L10=%.1f L50=%.1f L90=%.1f dB, n=%lu)\n",
+                s.period == LevelPeriod::MINUTE ? "minute" : "hour", s.l10, s.l50, s.l90,
+                (unsigned long)s.count);
+#endif
+  return true;
+}
+
+bool saveMinuteSummary(const MinuteSummary& s) {
+  size_t alignedSize = 0;
+  if (!beginRecord(48, alignedSize)) return false;
+  uint8_t* ptr = logBuffer;
+
+  memcpy(ptr, "VSUM", 4);                                  ptr += 4;
+  memcpy(ptr, &s.start, sizeof(s.start));                  ptr += sizeof(s.start);
+  memcpy(ptr, &s.frames, sizeof(s.frames));                ptr += sizeof(s.frames);
+  memcpy(ptr, &s.voiceFrames, sizeof(s.voiceFrames));      ptr += sizeof(s.voiceFrames);
+  memcpy(ptr, &s.quietFrames, sizeof(s.quietFrames));      ptr += sizeof(s.quietFrames);
+  uint8_t pool = FFT_POOL_POLICY;                          memcpy(ptr, &pool, sizeof(pool)); ptr += sizeof(pool);
+  ptr += 1;                                                // reserved
+  memcpy(ptr, &s.intensityMean, sizeof(s.intensityMean));  ptr += sizeof(s.intensityMean);
+  memcpy(ptr, &s.voiceScoreMean, sizeof(s.voiceScoreMean)); ptr += sizeof(s.voiceScoreMean);
+  memcpy(ptr, &s.snrMean, sizeof(s.snrMean));              ptr += sizeof(s.snrMean);
+  memcpy(ptr, &s.sfmMean, sizeof(s.sfmMean));              ptr += sizeof(s.sfmMean);
+  memcpy(ptr, &s.noiseRMSMean, sizeof(s.noiseRMSMean));    ptr += sizeof(s.noiseRMSMean);
+  memcpy(ptr, &s.bandRMSMean, sizeof(s.bandRMSMean));      ptr += sizeof(s.bandRMSMean);
+  memcpy(ptr, &s.levelRMSMean, sizeof(s.levelRMSMean));    ptr += sizeof(s.levelRMSMean);
+
+  if (!commitRecord(alignedSize)) return false;
+
+#if DEBUG_FFT_LOGGER
+  Serial.printf("[SD] Wrote minute summary (frames=%u voice=%u quiet=%u)\n",
+                s.frames, s.voiceFrames, s.quietFrames);
+#endif
+  return true;
+}
+
+bool flushFFTLogger(bool force) {
+  if (!sdReady || !logFile || !stageBuffer || logOffset == stageStart) return true;
+  if (!force && millis() - stageOldestMs < LOG_FLUSH_AGE_MS) return true;
+  return flushStage(true);
+}
+
+LoggerWriteStats getLoggerWriteStats() {
+  LoggerWriteStats s = writeStats;
+  s.staged = logOffset - stageStart;
+  return s;
+}
+
 bool isLoggerReady() {
   return (loggerStatus == LoggerStatus::OK);
 }
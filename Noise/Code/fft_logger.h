@@ -1,5 +1,67 @@
 #pragma once
 #include <Arduino.h>
+#include "fft_engine.h"
+#include "level_meter.h"
+#include "level_stats.h"
+#include "minute_summary.h"
+#include "spectrum_codec.h"
+
+// === Record type written per frame ===
+// SPECTRUM: "FFT2" header + every (frequency, magnitude) pair (16 KB at 2048 bins)
+// BANDS:    "FFTB" header + THIRD_OCTAVE_BANDS band levels and LAeq (one sector)
+// COMPACT:  "FFT3" header (features, pooling policy, engine config, scale) +
+//           magnitudes only, FFT3_ENCODING-coded (4.5 KB F16 / 2.5 KB LOG8 at
+//           2048 bins); each log file then starts with an "FGRD" record
+//           holding the frequency grid once
+// Quiet frames are "FFTQ" (one sector) either way. Level-meter seconds drained
+// with a frame follow it as an "LVL1" record (one sector), and each closed
+// minute/hour of statistical levels is an "LSUM" record (one sector), each
+// closed minute of voice statistics a "VSUM" record (one sector).
+#define FFT_LOG_SPECTRUM  0
+#define FFT_LOG_BANDS     1
+#define FFT_LOG_COMPACT   2
+#ifndef FFT_LOG_RECORD
+#define FFT_LOG_RECORD    FFT_LOG_SPECTRUM
+#endif
+
+// === Write-behind staging ===
+// Records are appended to a PSRAM ring and reach the card in LOG_FLUSH_CHUNK
+// writes at chunk-aligned file offsets (whole clusters), or all at once when
+// the oldest staged record is LOG_FLUSH_AGE_MS old. The index files are
+// rewritten once per flush. A failed write loses what was staged (at most
+// LOG_STAGE_BYTES); the reinit resumes from the file size as before.
+// false (or no PSRAM for the ring): one seek + write per record.
+#ifndef LOG_STAGING_ENABLED
+#define LOG_STAGING_ENABLED true
+#endif
+#define LOG_FLUSH_CHUNK  (128UL * 1024UL)
+#define LOG_STAGE_BYTES  (2 * LOG_FLUSH_CHUNK)   // ring position = file offset % LOG_STAGE_BYTES
+// Default FFT2 logging (one 16.5 KB frame per 1.5 s burst cycle, ~11 KB/s)
+// fills a chunk in ~12 s, so chunk flushes come first and the age limit only
+// bounds the loss for sparse records (FFTB/FFTQ: a chunk is ~6 min of frames).
+// Below the chunk fill time every flush would be a partial, unaligned write
+// with its own index update.
+#define LOG_FLUSH_AGE_MS 30000
+
+// === Preallocated log files ===
+// Each new LOG_XXXX.BIN is created at its full size (500 MB), contiguous where
+// the card's free space allows, and records overwrite it in place: appending no
+// longer allocates clusters or rewrites the FAT and directory entry. Sector 0
+// is a "LOGH" header holding the write pointer (end of valid data), rewritten
+// with the index files; past it the file holds stale card data, so readers
+// stop there. Files without the header are continued as before.
+#ifndef LOG_PREALLOCATE
+#define LOG_PREALLOCATE true
+#endif
+
+// === Frame index sidecar ===
+// Every LOG_INDEX_EVERY-th frame record (FFT2, FFT3, FFTB, FFTQ) of a
+// LOG_XXXX.BIN gets a (timestamp, offset) entry in LOG_XXXX.IDX, appended with
+// the index files once the record is on the card. Readers binary-search it to
+// start parsing near a time window instead of at offset 0. 0: no sidecar.
+#ifndef LOG_INDEX_EVERY
+#define LOG_INDEX_EVERY 16
+#endif
 
 enum class LoggerStatus {
   NOT_READY,
@@ -17,12 +79,37 @@ void deinitFFTLogger();
 bool recoverFFTLogger();
 
 // === Runtime Logging ===
-bool saveFFTFrame(const float* frequencies, const float* magnitudes, size_t count);
+// features/timestamp belong to the frame (snapshotted when it was produced)
+bool saveFFTFrame(const float* frequencies, const float* magnitudes, size_t count,
+                  const FFTFeatures& features, uint64_t timestamp);
+bool saveBandFrame(const float* bandLevels, size_t bands,
+                   const FFTFeatures& features, uint64_t timestamp);
+bool saveCompactFrame(const float* magnitudes, size_t count,
+                      const FFTFeatures& features, uint64_t timestamp);
+bool saveLevelSeconds(const LevelSecond* seconds, size_t count);   // count <= 255
+bool saveLevelSummary(const LevelSummary& summary);
+bool saveMinuteSummary(const MinuteSummary& summary);
+
+// Write staged records now (force), or only once the oldest is
+// LOG_FLUSH_AGE_MS old; for the logger task when no record arrives
+bool flushFFTLogger(bool force = true);
 
 // === Runtime Status ===
 LoggerStatus getLoggerStatus();
 bool isLoggerReady();
 
+// Card writes since boot: per record without staging, per flushed chunk with
+// it. Compare the two with LOG_STAGING_ENABLED on and off.
+struct LoggerWriteStats {
+  uint32_t writes;        // write() calls
+  uint64_t bytes;
+  uint64_t writeUs;       // time spent in write()
+  uint32_t maxWriteUs;
+  uint32_t indexUpdates;  // persistIndices() calls
+  uint32_t staged;        // bytes staged, not on the card yet
+};
+LoggerWriteStats getLoggerWriteStats();
+
 // === Maintenance ===
 bool formatSDCard(bool erase = false);
 
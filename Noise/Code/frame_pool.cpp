@@ -0,0 +1,68 @@
+#include "frame_pool.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "esp_heap_caps.h"
+
+// Free slot indices live in a FreeRTOS queue, so acquire (FFT task) and
+// release (logger task) need no extra locking.
+static QueueHandle_t freeSlots = nullptr;
+static FFTFrame frames[FRAME_POOL_SLOTS];
+static float* magnitudeBlock = nullptr;
+static uint32_t exhaustedCount = 0;
+
+bool initFramePool(const float* sharedFrequencies, size_t bins) {
+  if (!sharedFrequencies || bins == 0) return false;
+
+  magnitudeBlock = (float*)heap_caps_malloc(sizeof(float) * bins * FRAME_POOL_SLOTS, MALLOC_CAP_SPIRAM);
+  freeSlots = xQueueCreate(FRAME_POOL_SLOTS, sizeof(uint8_t));
+  if (!magnitudeBlock || !freeSlots) {
+    Serial.println("[POOL] Frame pool allocation failed");
+    deinitFramePool();
+    return false;
+  }
+
+  for (uint8_t i = 0; i < FRAME_POOL_SLOTS; ++i) {
+    frames[i].frequencies = sharedFrequencies;
+    frames[i].magnitudes = magnitudeBlock + (size_t)i * bins;
+    frames[i].count = bins;
+    xQueueSend(freeSlots, &i, 0);
+  }
+  exhaustedCount = 0;
+
+  Serial.printf("[POOL] %d frame slots × %u bins (%u bytes PSRAM)\n",
+                FRAME_POOL_SLOTS, (unsigned)bins, (unsigned)(sizeof(float) * bins * FRAME_POOL_SLOTS));
+  return true;
+}
+
+void deinitFramePool() {
+  if (freeSlots) { vQueueDelete(freeSlots); freeSlots = nullptr; }
+  if (magnitudeBlock) { free(magnitudeBlock); magnitudeBlock = nullptr; }
+  for (uint8_t i = 0; i < FRAME_POOL_SLOTS; ++i) frames[i] = FFTFrame{};
+}
+
+uint8_t acquireFrame() {
+  uint8_t index = FRAME_POOL_NONE;
+  if (!freeSlots || xQueueReceive(freeSlots, &index, 0) != pdTRUE) {
+    exhaustedCount++;
+#if DEBUG_FRAME_POOL
+    Serial.println("[POOL] No free frame slot");
+#endif
+    return FRAME_POOL_NONE;
+  }
+  return index;
+}
+
+FFTFrame* getFrame(uint8_t index) {
+  return (index < FRAME_POOL_SLOTS) ? &frames[index] : nullptr;
+}
+
+void releaseFrame(uint8_t index) {
+  if (!freeSlots || index >= FRAME_POOL_SLOTS) return;
+  xQueueSend(freeSlots, &index, 0);
+}
+
+uint32_t getFramePoolExhausted() { return exhaustedCount; }
+
+uint32_t getFramePoolInUse() {
+  return freeSlots ? FRAME_POOL_SLOTS - (uint32_t)uxQueueMessagesWaiting(freeSlots) : 0;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <Arduino.h>
+#include <stdint.h>
+#include "fft_engine.h"
+#include "level_meter.h"
+#include "level_stats.h"
+
+// === Optional compile-time debug ===
+#define DEBUG_FRAME_POOL false
+
+// === Config ===
+// Slots = frames that can be in flight at once: one being filled by the FFT
+// task, FFT_QUEUE_LENGTH waiting in fftQueue, one being written by the logger.
+#define FRAME_POOL_SLOTS 6
+#define FRAME_POOL_NONE  0xFF
+
+// === Frame slot ===
+// magnitudes is owned by the slot; frequencies is the engine's table
+// (getFFTFrequencies()), identical for every frame and never copied.
+// features/timestamp are snapshotted with the spectrum, so a frame queued
+// behind a slow SD write still carries its own detector output and time.
+struct FFTFrame {
+  const float* frequencies;
+  float* magnitudes;
+  size_t count;
+  float bandLevels[THIRD_OCTAVE_BANDS];   // dB, getFFTBandLevels() of this frame
+  FFTFeatures features;
+  uint64_t timestamp;     // time(nullptr) when the frame was finalized
+  LevelSecond levelSeconds[LEVEL_SECONDS_PER_FRAME];   // level-meter seconds closed since the last frame
+  uint8_t levelCount;
+  float levelDB;          // level fed to the L10/L50/L90 statistics (see publishFFTFrame())
+};
+
+// === Lifecycle ===
+bool initFramePool(const float* sharedFrequencies, size_t bins);   // One PSRAM block for all slots
+void deinitFramePool();
+
+// === Slots (passed through queues by index) ===
+uint8_t acquireFrame();                  // FRAME_POOL_NONE if every slot is in flight
+FFTFrame* getFrame(uint8_t index);
+void releaseFrame(uint8_t index);        // Consumer hands the slot back
+
+// === Diagnostics ===
+uint32_t getFramePoolExhausted();        // acquireFrame() calls that found no free slot
+uint32_t getFramePoolInUse();
@@ -0,0 +1,143 @@
+#include "level_meter.h"
+#include "signal_config.h"
+#include "fft_engine.h"   // LEVEL_DB_OFFSET, LEVEL_DB_FLOOR, FFT_QUIET_GATE
+
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+
+#if LEVEL_METER_ENABLED && FFT_QUIET_GATE
+#error "The level meter needs every window's spectrum: build it with FFT_QUIET_GATE off"
+#endif
+
+// === Time weighting ===
+// Exponential averages of the window powers, one step per hop (46 ms at 2048 /
+// 44.1 kHz against the 125 ms Fast constant). A-weighting is applied by the
+// engine per bin with the same IEC 61672 curve as its LAeq (aWeightingPower()),
+// so the meter and the frame levels agree on steady signals.
+struct MeterState {
+  float fast, slow;         // time-weighted power (V^2)
+};
+
+static MeterState state;
+static bool meterReady = false;
+static bool meterSeeded = false;   // Fast/Slow start from the first window
+static float fastAlpha = 0.0f, slowAlpha = 0.0f;   // per hop
+
+// Open second
+static double secSumSq = 0.0;      // power x samples
+static uint32_t secSamples = 0;
+static float secFastMax = 0.0f, secFastMin = 0.0f, secSlowMax = 0.0f, secSlowMin = 0.0f;
+
+// Closed seconds, fftTask only (pushed and drained by the same task)
+static LevelSecond queue[LEVEL_SECOND_QUEUE];
+static uint32_t queueClosedMs[LEVEL_SECOND_QUEUE];
+static size_t queueHead = 0, queueCount = 0;
+static LevelMeterStats stats = {};
+
+static inline float toDB(float power) {
+  return power > 0.0f ? fmaxf(10.0f * log10f(power) + LEVEL_DB_OFFSET, LEVEL_DB_FLOOR) : LEVEL_DB_FLOOR;
+}
+
+static void openSecond() {
+  secSumSq = 0.0;
+  secSamples = 0;
+  secFastMax = secSlowMax = 0.0f;
+  secFastMin = secSlowMin = INFINITY;
+}
+
+static void closeSecond() {
+  if (queueCount == LEVEL_SECOND_QUEUE) {
+    // Nobody drained: drop the oldest, keep the latest
+    queueHead = (queueHead + 1) % LEVEL_SECOND_QUEUE;
+    queueCount--;
+    stats.secondsDropped++;
+  }
+  const size_t slot = (queueHead + queueCount) % LEVEL_SECOND_QUEUE;
+  queue[slot] = LevelSecond{ 0, toDB((float)(secSumSq / secSamples)),
+                             toDB(secFastMax), toDB(secFastMin), toDB(secSlowMax), toDB(secSlowMin),
+                             secSamples };
+  queueClosedMs[slot] = millis();
+  queueCount++;
+  stats.secondsClosed++;
+
+#if DEBUG_LEVEL_METER
+  const LevelSecond& s = queue[slot];
+  Serial.printf("[LEVEL] LAeq=%.1f LAFmax=%.1f LAFmin=%.1f LASmax=%.1f dB\n",
+                s.laeq, s.lafMax, s.lafMin, s.lasMax);
+#endif
+  openSecond();
+}
+
+bool initLevelMeter() {
+  fastAlpha = 1.0f - expf(-(float)FFT_STEP_SIZE / (LEVEL_FAST_TAU_S * SAMPLE_RATE));
+  slowAlpha = 1.0f - expf(-(float)FFT_STEP_SIZE / (LEVEL_SLOW_TAU_S * SAMPLE_RATE));
+  stats = LevelMeterStats{};
+  meterReady = true;
+  resetLevelMeter();
+
+  Serial.printf("[LEVEL] Meter initialized — A-weighted window powers every %d samples, F/S\n",
+                FFT_STEP_SIZE);
+  return true;
+}
+
+void resetLevelMeter() {
+  state.fast = state.slow = 0.0f;
+  meterSeeded = false;
+  queueHead = queueCount = 0;
+  openSecond();
+}
+
+static void noteReading() {
+  secFastMax = fmaxf(secFastMax, state.fast);
+  secFastMin = fminf(secFastMin, state.fast);
+  secSlowMax = fmaxf(secSlowMax, state.slow);
+  secSlowMin = fminf(secSlowMin, state.slow);
+}
+
+// Each window stands for the hop it advanced by. A hop that straddles a second
+// boundary splits its energy between the two seconds; its Fast/Slow reading
+// counts for the second it ends in.
+void levelMeterPushWindows(const float* aPower, size_t count) {
+  if (!meterReady || !aPower) return;
+  for (size_t w = 0; w < count; ++w) {
+    const float p = aPower[w];
+    if (!meterSeeded) {
+      state.fast = state.slow = p;
+      meterSeeded = true;
+    } else {
+      state.fast += fastAlpha * (p - state.fast);
+      state.slow += slowAlpha * (p - state.slow);
+    }
+    stats.samples += FFT_STEP_SIZE;
+
+    uint32_t left = FFT_STEP_SIZE;
+    while (left > 0) {
+      const uint32_t n = std::min<uint32_t>(left, SAMPLE_RATE - secSamples);
+      secSumSq += (double)p * n;
+      secSamples += n;
+      left -= n;
+      if (left == 0) noteReading();
+      if (secSamples == SAMPLE_RATE) closeSecond();
+    }
+  }
+}
+
+size_t drainLevelSeconds(LevelSecond* out, size_t maxCount, uint64_t now) {
+  if (!out) return 0;
+  const uint32_t nowMs = millis();
+  size_t n = 0;
+  while (n < maxCount && queueCount > 0) {
+    out[n] = queue[queueHead];
+    out[n].timestamp = now - (nowMs - queueClosedMs[queueHead]) / 1000;
+    queueHead = (queueHead + 1) % LEVEL_SECOND_QUEUE;
+    queueCount--;
+    n++;
+  }
+  return n;
+}
+
+float getLevelFastDB() { return toDB(state.fast); }
+float getLevelSlowDB() { return toDB(state.slow); }
+bool isLevelMeterSettled() { return meterReady && meterSeeded; }
+LevelMeterStats getLevelMeterStats() { return stats; }
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <Arduino.h>
+#include <stdint.h>
+#include "signal_config.h"
+
+// === Optional compile-time debug ===
+#define DEBUG_LEVEL_METER false
+
+// === Sound level meter: A-weighting + Fast/Slow time weighting ===
+// Fed with the engine's A-weighted window powers (drainFFTWindowLevels()), one
+// per hop: the spectrum is computed anyway, so A-weighting costs one pass over
+// its bins instead of a filter cascade per sample. Fast and Slow integrate the
+// window powers hop by hop. A window spans FFT_SIZE samples (Hamming), so
+// events shorter than that are smoothed before the Fast weighting sees them.
+// Levels are dB re 1 V^2 plus LEVEL_DB_OFFSET, like the engine's band levels.
+// A "second" closes every SAMPLE_RATE samples of hops, i.e. a wall-clock second
+// of continuous capture.
+// Continuous capture only: in burst mode a "second" would be two 500 ms
+// captures 1 s apart, with Fast/Slow carried across the gaps (LAFmax / LASmin
+// of a spliced signal). Burst frames keep their own LAeq. The quiet gate
+// leaves quiet frames without window powers, so it cannot run with the meter.
+#ifndef LEVEL_METER_ENABLED
+#define LEVEL_METER_ENABLED (CAPTURE_MODE == CAPTURE_MODE_CONTINUOUS)
+#endif
+#if LEVEL_METER_ENABLED && CAPTURE_MODE != CAPTURE_MODE_CONTINUOUS
+#error "LEVEL_METER_ENABLED needs CAPTURE_MODE_CONTINUOUS"
+#endif
+#define LEVEL_FAST_TAU_S        0.125f   // IEC 61672 F
+#define LEVEL_SLOW_TAU_S        1.0f     // IEC 61672 S
+#define LEVEL_SECOND_QUEUE      8        // closed seconds held until drained
+#define LEVEL_SECONDS_PER_FRAME 4        // drained into each published FFT frame
+
+// === Per-second record ===
+struct LevelSecond {
+  uint64_t timestamp;     // unix time the second closed (drainLevelSeconds())
+  float laeq;             // dB, energy mean of the A-weighted signal
+  float lafMax, lafMin;   // dB, Fast time-weighted extremes
+  float lasMax, lasMin;   // dB, Slow time-weighted extremes
+  uint32_t samples;       // samples measured (SAMPLE_RATE)
+};
+
+struct LevelMeterStats {
+  uint32_t secondsClosed;
+  uint32_t secondsDropped;   // queue full when the second closed
+  uint64_t samples;          // samples of the hops measured since init
+};
+
+// === Lifecycle ===
+bool initLevelMeter();       // Time weighting + state
+void resetLevelMeter();      // ✅ Soft reset: Fast/Slow restart, open second and queue dropped
+
+// === Processing ===
+// A-weighted mean square (V^2) of consecutive windows, FFT_STEP_SIZE apart
+void levelMeterPushWindows(const float* aPower, size_t count);
+
+// === Results ===
+// Oldest first; returns how many were copied. now = time(nullptr) of the caller.
+size_t drainLevelSeconds(LevelSecond* out, size_t maxCount, uint64_t now);
+float getLevelFastDB();      // current Fast / Slow readings
+float getLevelSlowDB();
+bool isLevelMeterSettled();  // a window measured since init/reset
+LevelMeterStats getLevelMeterStats();
@@ -0,0 +1,106 @@
+#include "level_stats.h"
+
+#include <math.h>
+#include <string.h>
+
+struct LevelHistogram {
+  uint32_t counts[LEVEL_HIST_BINS];
+  uint32_t total;
+  uint64_t key;             // timestamp / period length of the open period
+  double energy;            // sum of 10^(L/10)
+  float lmin, lmax;
+};
+
+static const uint32_t PERIOD_SECONDS[2] = { 60, 3600 };
+static LevelHistogram hist[2];   // indexed by LevelPeriod
+
+static void clearHistogram(LevelHistogram& h) {
+  memset(h.counts, 0, sizeof(h.counts));
+  h.total = 0;
+  h.energy = 0.0;
+  h.lmin = INFINITY;
+  h.lmax = -INFINITY;
+}
+
+// Level exceeded by `percent` of the samples: walk down from the top bin and
+// interpolate inside the bin where the running count crosses the target.
+static float exceededLevel(const LevelHistogram& h, float percent) {
+  const float target = h.total * percent / 100.0f;
+  float above = 0.0f;
+  for (int i = LEVEL_HIST_BINS - 1; i >= 0; --i) {
+    const float c = (float)h.counts[i];
+    if (c > 0.0f && above + c >= target) {
+      const float top = LEVEL_HIST_MIN_DB + (i + 1) * LEVEL_HIST_STEP_DB;
+      const float level = top - LEVEL_HIST_STEP_DB * (target - above) / c;
+      return fminf(fmaxf(level, h.lmin), h.lmax);   // end bins also hold clamped levels
+    }
+    above += c;
+  }
+  return h.lmin;
+}
+
+static LevelSummary summarize(const LevelHistogram& h, LevelPeriod period) {
+  LevelSummary s;
+  s.start = h.key * PERIOD_SECONDS[(int)period];
+  s.period = period;
+  s.count = h.total;
+  s.l10 = exceededLevel(h, 10.0f);
+  s.l50 = exceededLevel(h, 50.0f);
+  s.l90 = exceededLevel(h, 90.0f);
+  s.leq = (float)(10.0 * log10(h.energy / h.total));
+  s.lmin = h.lmin;
+  s.lmax = h.lmax;
+
+#if DEBUG_LEVEL_STATS
+  Serial.printf("[LSTAT] %s %llu: n=%lu L10=%.1f L50=%.1f L90=%.1f Leq=%.1f dB\n",
+                period == LevelPeriod::MINUTE ? "minute" : "hour", (unsigned long long)s.start,
+                (unsigned long)s.count, s.l10, s.l50, s.l90, s.leq);
+#endif
+  return s;
+}
+
+void initLevelStats() {
+  resetLevelStats();
+  Serial.printf("[LSTAT] Minute/hour histograms: %d bins × %.1f dB from %.0f dB (%u bytes)\n",
+                LEVEL_HIST_BINS, LEVEL_HIST_STEP_DB, LEVEL_HIST_MIN_DB, (unsigned)sizeof(hist));
+}
+
+void resetLevelStats() {
+  for (LevelHistogram& h : hist) clearHistogram(h);
+}
+
+size_t levelStatsPush(float levelDB, uint64_t timestamp, LevelSummary* closed) {
+  if (!closed || !isfinite(levelDB)) return 0;
+
+  int bin = (int)floorf((levelDB - LEVEL_HIST_MIN_DB) / LEVEL_HIST_STEP_DB);
+  bin = bin < 0 ? 0 : (bin >= LEVEL_HIST_BINS ? LEVEL_HIST_BINS - 1 : bin);
+  const double energy = pow(10.0, levelDB / 10.0);
+
+  size_t n = 0;
+  for (int p = 0; p < 2; ++p) {
+    LevelHistogram& h = hist[p];
+    const uint64_t key = timestamp / PERIOD_SECONDS[p];
+    if (h.total > 0 && key != h.key) {
+      closed[n++] = summarize(h, (LevelPeriod)p);
+      clearHistogram(h);
+    }
+    h.key = key;
+    h.counts[bin]++;
+    h.total++;
+    h.energy += energy;
+    h.lmin = fminf(h.lmin, levelDB);
+    h.lmax = fmaxf(h.lmax, levelDB);
+  }
+  return n;
+}
+
+size_t levelStatsFlush(LevelSummary* closed) {
+  if (!closed) return 0;
+  size_t n = 0;
+  for (int p = 0; p < 2; ++p) {
+    if (hist[p].total == 0) continue;
+    closed[n++] = summarize(hist[p], (LevelPeriod)p);
+    clearHistogram(hist[p]);
+  }
+  return n;
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <Arduino.h>
+#include <stdint.h>
+
+// === Optional compile-time debug ===
+#define DEBUG_LEVEL_STATS false
+
+// === Statistical levels (L10/L50/L90) per minute and per hour ===
+// One level per frame goes into a fixed log-spaced histogram per period:
+// constant memory, O(1) per update. Ln = level exceeded n% of the period,
+// interpolated within its LEVEL_HIST_STEP_DB bin. Periods are wall-clock
+// aligned (unix minute / hour of the frame timestamp) and close when a frame
+// from a later period arrives, or on levelStatsFlush().
+#ifndef LEVEL_STATS_ENABLED
+#define LEVEL_STATS_ENABLED true
+#endif
+#define LEVEL_HIST_MIN_DB   (-130.0f)   // lowest bin edge (dB, same scale as the level meter)
+#define LEVEL_HIST_STEP_DB  0.5f
+#define LEVEL_HIST_BINS     280         // up to +10 dB; out-of-range levels land in the end bins
+
+enum class LevelPeriod : uint8_t { MINUTE = 0, HOUR = 1 };
+
+struct LevelSummary {
+  uint64_t start;         // unix time the period began
+  LevelPeriod period;
+  uint32_t count;         // levels accumulated
+  float l10, l50, l90;    // dB
+  float leq;              // dB, energy mean of the accumulated levels
+  float lmin, lmax;       // dB, exact (not binned)
+};
+
+// === Lifecycle ===
+void initLevelStats();
+void resetLevelStats();   // ✅ Soft reset: open periods dropped
+
+// === Processing (single task) ===
+// Returns the summaries closed by this level (0–2, minute before hour).
+size_t levelStatsPush(float levelDB, uint64_t timestamp, LevelSummary* closed);
+size_t levelStatsFlush(LevelSummary* closed);   // close both open periods
@@ -0,0 +1,93 @@
+#include "minute_summary.h"
+
+#include <math.h>
+
+// Host aggregation constants (noise_spectrum_preparation.py)
+#define SUMMARY_NOISE_RMS_FLOOR  1e-6f
+#define SUMMARY_SNR_CAP          1e4f
+#define SCORE_W_RISE  0.5f
+#define SCORE_W_SNR   0.3f
+#define SCORE_W_HARM  0.2f
+
+struct MinuteAccumulator {
+  uint64_t minute;             // timestamp / 60
+  uint32_t frames, voiceFrames, quietFrames;
+  double intensity, voiceScore, snr, sfm, noiseRMS, bandRMS, levelRMS;
+};
+
+static MinuteAccumulator acc;
+
+static inline float clamp01(float x) { return fminf(fmaxf(x, 0.0f), 1.0f); }
+
+static MinuteSummary summarize(const MinuteAccumulator& a) {
+  const double n = a.frames;
+  auto cap16 = [](uint32_t v) { return (uint16_t)(v > UINT16_MAX ? UINT16_MAX : v); };
+  MinuteSummary s;
+  s.start = a.minute * 60;
+  s.frames = cap16(a.frames);
+  s.voiceFrames = cap16(a.voiceFrames);
+  s.quietFrames = cap16(a.quietFrames);
+  s.intensityMean = (float)(a.intensity / n);
+  s.voiceScoreMean = (float)(a.voiceScore / n);
+  s.snrMean = (float)(a.snr / n);
+  s.sfmMean = (float)(a.sfm / n);
+  s.noiseRMSMean = (float)(a.noiseRMS / n);
+  s.bandRMSMean = (float)(a.bandRMS / n);
+  s.levelRMSMean = (float)(a.levelRMS / n);
+
+#if DEBUG_MINUTE_SUMMARY
+  Serial.printf("[MINUTE] %llu: frames=%u voice=%u quiet=%u SNR=%.2f SFM=%.2f\n",
+                (unsigned long long)s.start, s.frames, s.voiceFrames, s.quietFrames, s.snrMean, s.sfmMean);
+#endif
+  return s;
+}
+
+void initMinuteSummary() {
+  resetMinuteSummary();
+  Serial.println("[MINUTE] Per-minute voice summary enabled");
+}
+
+void resetMinuteSummary() {
+  acc = MinuteAccumulator{};
+}
+
+bool minuteSummaryPush(const FFTFeatures& f, uint64_t timestamp, MinuteSummary* closed) {
+  if (!closed) return false;
+
+  const uint64_t minute = timestamp / 60;
+  bool didClose = false;
+  if (acc.frames > 0 && minute != acc.minute) {
+    *closed = summarize(acc);
+    acc = MinuteAccumulator{};
+    didClose = true;
+  }
+  acc.minute = minute;
+
+  const float snr = fminf(fmaxf(f.snr, 0.0f), SUMMARY_SNR_CAP);
+  acc.frames++;
+  acc.snr += snr;
+  acc.sfm += f.sfm;
+  acc.noiseRMS += fmaxf(f.noiseRMS, SUMMARY_NOISE_RMS_FLOOR);
+  acc.bandRMS += f.bandRMS;
+  acc.levelRMS += f.levelRMS;
+  if (f.quiet) {
+    acc.quietFrames++;
+  } else {
+    // intensityDB is the rise over the baseline, clamped at 0 like the host's rise_db
+    acc.voiceScore += SCORE_W_RISE * clamp01(f.intensityDB / 12.0f) +
+                      SCORE_W_SNR * clamp01((snr - 1.0f) / 4.0f) +
+                      SCORE_W_HARM * clamp01(1.0f - f.sfm);
+    if (f.voice) {
+      acc.voiceFrames++;
+      acc.intensity += f.intensityDB;
+    }
+  }
+  return didClose;
+}
+
+bool minuteSummaryFlush(MinuteSummary* closed) {
+  if (!closed || acc.frames == 0) return false;
+  *closed = summarize(acc);
+  acc = MinuteAccumulator{};
+  return true;
+}
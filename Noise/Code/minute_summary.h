@@ -0,0 +1,37 @@
+#pragma once
+
+#include <Arduino.h>
+#include <stdint.h>
+#include "fft_engine.h"
+
+// === Optional compile-time debug ===
+#define DEBUG_MINUTE_SUMMARY false
+
+// === Per-minute voice summary ===
+// The per-minute statistics noise_spectrum_preparation.py derives from full
+// spectra (per_kit_worker()), accumulated on the device from each frame's
+// features over the unix minute of its timestamp. Quiet frames count as
+// frames with SNR 0, SFM 1 and no voice, as in the host aggregation.
+#ifndef MINUTE_SUMMARY_ENABLED
+#define MINUTE_SUMMARY_ENABLED true
+#endif
+
+struct MinuteSummary {
+  uint64_t start;              // unix time of the minute
+  uint16_t frames, voiceFrames, quietFrames;
+  float intensityMean;         // dB, voice frames' intensity (0 for the others)
+  float voiceScoreMean;        // 0–1, rise/SNR/harmonicity score (spectral frames)
+  float snrMean;               // linear
+  float sfmMean;
+  float noiseRMSMean, bandRMSMean;
+  float levelRMSMean;          // V, time-domain level (quiet gate)
+};
+
+// === Lifecycle ===
+void initMinuteSummary();
+void resetMinuteSummary();     // ✅ Soft reset: open minute dropped
+
+// === Processing (single task) ===
+// True when this frame closed the previous minute (copied to *closed).
+bool minuteSummaryPush(const FFTFeatures& features, uint64_t timestamp, MinuteSummary* closed);
+bool minuteSummaryFlush(MinuteSummary* closed);   // close the open minute
@@ -0,0 +1,96 @@
+#include "pipeline_queue.h"
+
+bool initPipelineQueue(PipelineQueue& q, const char* name, uint32_t length,
+                       BackpressurePolicy policy, TickType_t blockTicks,
+                       void (*onDrop)(uint8_t item)) {
+  q = PipelineQueue{};
+  q.name = name;
+  q.length = length;
+  q.policy = policy;
+  q.blockTicks = blockTicks;
+  q.onDrop = onDrop;
+  q.handle = xQueueCreate(length, sizeof(uint8_t));
+  if (!q.handle) {
+    Serial.printf("[PIPE] %s: queue creation failed\n", name);
+    return false;
+  }
+  Serial.printf("[PIPE] %s: length %lu, policy %s\n", name, (unsigned long)length, backpressurePolicyName(policy));
+  return true;
+}
+
+void deinitPipelineQueue(PipelineQueue& q) {
+  if (q.handle) { vQueueDelete(q.handle); q.handle = nullptr; }
+}
+
+static void noteDepth(PipelineQueue& q) {
+  uint32_t depth = (uint32_t)uxQueueMessagesWaiting(q.handle);
+  if (depth > q.stats.maxDepth) q.stats.maxDepth = depth;
+}
+
+bool pipelineSend(PipelineQueue& q, uint8_t item) {
+  if (!q.handle) return false;
+
+  if (xQueueSend(q.handle, &item, 0) == pdTRUE) {
+    q.stats.sent++;
+    noteDepth(q);
+    return true;
+  }
+
+  switch (q.policy) {
+    case BackpressurePolicy::BLOCK:
+      q.stats.blocked++;
+      if (xQueueSend(q.handle, &item, q.blockTicks) == pdTRUE) {
+        q.stats.sent++;
+        noteDepth(q);
+        return true;
+      }
+      q.stats.blockTimeouts++;
+      break;
+
+    case BackpressurePolicy::DROP_NEWEST:
+      q.stats.droppedNewest++;
+      break;
+
+    case BackpressurePolicy::DROP_OLDEST: {
+      // The consumer may take the head first; then the retry simply succeeds
+      uint8_t oldest;
+      if (xQueueReceive(q.handle, &oldest, 0) == pdTRUE) {
+        q.stats.droppedOldest++;
+        if (q.onDrop) q.onDrop(oldest);
+      }
+      if (xQueueSend(q.handle, &item, 0) == pdTRUE) {
+        q.stats.sent++;
+        noteDepth(q);
+        return true;
+      }
+      q.stats.droppedNewest++;
+      break;
+    }
+  }
+
+  if (q.onDrop) q.onDrop(item);
+  return false;
+}
+
+bool pipelineReceive(PipelineQueue& q, uint8_t* item, TickType_t wait) {
+  if (!q.handle || !item) return false;
+  return xQueueReceive(q.handle, item, wait) == pdTRUE;
+}
+
+const char* backpressurePolicyName(BackpressurePolicy policy) {
+  switch (policy) {
+    case BackpressurePolicy::BLOCK:       return "block";
+    case BackpressurePolicy::DROP_NEWEST: return "drop-newest";
+    case BackpressurePolicy::DROP_OLDEST: return "drop-oldest";
+  }
+  return "?";
+}
+
+void printPipelineQueueStats(const PipelineQueue& q) {
+  Serial.printf("[PIPE] %s (%s): sent=%lu blocked=%lu timeouts=%lu dropNewest=%lu dropOldest=%lu maxDepth=%lu/%lu\n",
+                q.name, backpressurePolicyName(q.policy),
+                (unsigned long)q.stats.sent, (unsigned long)q.stats.blocked,
+                (unsigned long)q.stats.blockTimeouts, (unsigned long)q.stats.droppedNewest,
+                (unsigned long)q.stats.droppedOldest, (unsigned long)q.stats.maxDepth,
+                (unsigned long)q.length);
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <Arduino.h>
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+
+// === Backpressure policies ===
+enum class BackpressurePolicy {
+  BLOCK,         // wait up to blockTicks for space, then drop the new item
+  DROP_NEWEST,   // full → drop the new item immediately
+  DROP_OLDEST    // full → evict the oldest queued item, enqueue the new one
+};
+
+// === Counters (monotonic since init) ===
+struct PipelineQueueStats {
+  uint32_t sent;           // items accepted
+  uint32_t blocked;        // sends that had to wait (BLOCK)
+  uint32_t blockTimeouts;  // BLOCK waits that expired → new item dropped
+  uint32_t droppedNewest;  // DROP_NEWEST rejections
+  uint32_t droppedOldest;  // DROP_OLDEST evictions
+  uint32_t maxDepth;       // high-water mark
+};
+
+// Bounded queue of uint8_t handles (frame_pool slot indices). Dropped items
+// go to onDrop so their owner can reclaim them.
+struct PipelineQueue {
+  const char* name;
+  QueueHandle_t handle;
+  uint32_t length;
+  BackpressurePolicy policy;
+  TickType_t blockTicks;
+  void (*onDrop)(uint8_t item);
+  PipelineQueueStats stats;
+};
+
+// === Lifecycle ===
+bool initPipelineQueue(PipelineQueue& q, const char* name, uint32_t length,
+                       BackpressurePolicy policy, TickType_t blockTicks,
+                       void (*onDrop)(uint8_t item));
+void deinitPipelineQueue(PipelineQueue& q);
+
+// === Producer / consumer ===
+bool pipelineSend(PipelineQueue& q, uint8_t item);               // false = new item dropped
+bool pipelineReceive(PipelineQueue& q, uint8_t* item, TickType_t wait);
+
+// === Diagnostics ===
+const char* backpressurePolicyName(BackpressurePolicy policy);
+void printPipelineQueueStats(const PipelineQueue& q);
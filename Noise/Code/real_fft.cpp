@@ -0,0 +1,136 @@
+#include "real_fft.h"
+
+#include <Arduino.h>
+#include <math.h>
+#include "esp_heap_caps.h"
+
+// Tables are hit on every butterfly: prefer internal RAM, fall back to PSRAM.
+static void* allocTable(size_t bytes) {
+  void* p = heap_caps_malloc(bytes, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+  if (!p) p = heap_caps_malloc(bytes, MALLOC_CAP_SPIRAM);
+  return p;
+}
+
+bool initRealFFTPlan(RealFFTPlan& plan, size_t n) {
+  deinitRealFFTPlan(plan);
+  if (n < 4 || (n & (n - 1)) != 0 || n / 2 > 65536) return false;
+
+  const size_t half = n / 2;
+  plan.twiddle = (float*)allocTable(sizeof(float) * n);
+  plan.bitrev  = (uint16_t*)allocTable(sizeof(uint16_t) * half);
+  if (!plan.twiddle || !plan.bitrev) {
+    deinitRealFFTPlan(plan);
+    return false;
+  }
+  plan.n = n;
+
+  for (size_t k = 0; k < half; ++k) {
+    double a = 2.0 * M_PI * (double)k / (double)n;
+    plan.twiddle[2 * k]     = (float)cos(a);
+    plan.twiddle[2 * k + 1] = (float)-sin(a);
+  }
+
+  unsigned bits = 0;
+  while ((1u << bits) < half) bits++;
+  for (size_t i = 0; i < half; ++i) {
+    size_t r = 0;
+    for (unsigned b = 0; b < bits; ++b) {
+      if (i & (1u << b)) r |= 1u << (bits - 1 - b);
+    }
+    plan.bitrev[i] = (uint16_t)r;
+  }
+  return true;
+}
+
+void deinitRealFFTPlan(RealFFTPlan& plan) {
+  if (plan.twiddle) { free(plan.twiddle); plan.twiddle = nullptr; }
+  if (plan.bitrev)  { free(plan.bitrev);  plan.bitrev = nullptr; }
+  plan.n = 0;
+}
+
+// Radix-2 DIT complex FFT of M = N/2 interleaved points. W_M^j = W_N^{2j}, so the
+// N-point table serves every stage with stride N/len.
+static void complexFFT(const RealFFTPlan& plan, float* z) {
+  const size_t m = plan.n / 2;
+  const float* tw = plan.twiddle;
+
+  for (size_t i = 0; i < m; ++i) {
+    size_t j = plan.bitrev[i];
+    if (i < j) {
+      float tr = z[2 * i], ti = z[2 * i + 1];
+      z[2 * i] = z[2 * j];  z[2 * i + 1] = z[2 * j + 1];
+      z[2 * j] = tr;        z[2 * j + 1] = ti;
+    }
+  }
+
+  // len = 2: twiddle is 1
+  for (size_t i = 0; i < m; i += 2) {
+    float* a = z + 2 * i;
+    float* b = a + 2;
+    float br = b[0], bi = b[1];
+    b[0] = a[0] - br;  b[1] = a[1] - bi;
+    a[0] += br;        a[1] += bi;
+  }
+
+  for (size_t len = 4; len <= m; len <<= 1) {
+    const size_t halfLen = len >> 1;
+    const size_t stride = plan.n / len;
+    for (size_t i = 0; i < m; i += len) {
+      float* a = z + 2 * i;
+      float* b = a + 2 * halfLen;
+      for (size_t k = 0; k < halfLen; ++k) {
+        const float wr = tw[2 * k * stride];
+        const float wi = tw[2 * k * stride + 1];
+        const float br = b[2 * k], bi = b[2 * k + 1];
+        const float tr = br * wr - bi * wi;
+        const float ti = br * wi + bi * wr;
+        b[2 * k]     = a[2 * k] - tr;
+        b[2 * k + 1] = a[2 * k + 1] - ti;
+        a[2 * k]     += tr;
+        a[2 * k + 1] += ti;
+      }
+    }
+  }
+}
+
+void realFFTForward(const RealFFTPlan& plan, float* data) {
+  if (!plan.twiddle || !data) return;
+  const size_t m = plan.n / 2;
+  const float* tw = plan.twiddle;
+
+  complexFFT(plan, data);
+
+  // Split: X[k] = Fe + W^k Fo, X[M-k] = conj(Fe - W^k Fo)
+  // with Fe = (Z[k] + conj Z[M-k]) / 2, Fo = -i (Z[k] - conj Z[M-k]) / 2.
+  const float z0r = data[0], z0i = data[1];
+  data[0] = z0r + z0i;   // X[0]
+  data[1] = z0r - z0i;   // X[N/2]
+
+  for (size_t k = 1; k <= m / 2; ++k) {
+    const size_t j = m - k;
+    const float ar = data[2 * k], ai = data[2 * k + 1];
+    const float br = data[2 * j], bi = -data[2 * j + 1];
+
+    const float fer = 0.5f * (ar + br), fei = 0.5f * (ai + bi);
+    const float for_ = 0.5f * (ai - bi), foi = -0.5f * (ar - br);
+
+    const float wr = tw[2 * k], wi = tw[2 * k + 1];
+    const float tr = for_ * wr - foi * wi;
+    const float ti = for_ * wi + foi * wr;
+
+    data[2 * k]     = fer + tr;
+    data[2 * k + 1] = fei + ti;
+    data[2 * j]     = fer - tr;
+    data[2 * j + 1] = -(fei - ti);
+  }
+}
+
+void realFFTMagnitude(const RealFFTPlan& plan, float* data) {
+  if (!data) return;
+  const size_t bins = plan.n / 2;
+  data[0] = fabsf(data[0]);   // Nyquist (data[1]) is outside the N/2 bins
+  for (size_t k = 1; k < bins; ++k) {
+    const float re = data[2 * k], im = data[2 * k + 1];
+    data[k] = sqrtf(re * re + im * im);
+  }
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Real-input FFT: an N-point real transform computed as an N/2-point complex
+// FFT on the even/odd-interleaved input followed by a split pass.
+// Twiddles and the bit-reversal permutation are built once per plan.
+
+struct RealFFTPlan {
+  size_t n = 0;                // real transform length (power of two, >= 4)
+  float* twiddle = nullptr;    // W_N^k = (cos, -sin) for k < N/2, interleaved
+  uint16_t* bitrev = nullptr;  // bit-reversal permutation of the N/2-point FFT
+};
+
+// === Lifecycle ===
+bool initRealFFTPlan(RealFFTPlan& plan, size_t n);   // builds tables, false on bad size/alloc
+void deinitRealFFTPlan(RealFFTPlan& plan);
+
+// === Transform ===
+// In place: N real samples in; packed spectrum out —
+// data[0] = Re X[0], data[1] = Re X[N/2], data[2k], data[2k+1] = X[k] for 0 < k < N/2.
+void realFFTForward(const RealFFTPlan& plan, float* data);
+
+// Packed spectrum → |X[k]| for k < N/2, written to data[0 .. N/2).
+void realFFTMagnitude(const RealFFTPlan& plan, float* data);
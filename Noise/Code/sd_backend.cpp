@@ -0,0 +1,173 @@
+#include "sd_backend.h"
+#include <SD.h>
+#include <SD_MMC.h>
+#include <SPI.h>
+#include "signal_config.h"
+#include "esp_heap_caps.h"
+
+#define SDMMC_FOUR_BIT (SD_D1 >= 0 && SD_D2 >= 0)
+
+static const char* busFile = "/log_bus.txt";        // SPI write rate (bytes/s) measured on this card
+static const char* selfTestFile = "/log_bus.tmp";
+
+// Both buses share the socket: park every line with CS/DAT3 high
+static void releasePins() {
+  pinMode(SD_CS, OUTPUT);
+  digitalWrite(SD_CS, HIGH);     // deselect card
+  pinMode(SD_MOSI, INPUT);
+  pinMode(SD_SCK,  INPUT);
+  pinMode(SD_MISO, INPUT);
+#if SDMMC_FOUR_BIT
+  pinMode(SD_D1, INPUT);
+  pinMode(SD_D2, INPUT);
+#endif
+}
+
+// === SPI ===
+static bool spiBegin() {
+  SPI.begin(SD_SCK, SD_MISO, SD_MOSI, SD_CS);
+  delay(100);
+  return SD.begin(SD_CS, SPI, LOG_SPI_FREQ_HZ);
+}
+
+static void spiEnd() {
+  releasePins();
+  SD.end();
+  SPI.end();
+}
+
+static uint8_t spiCardType() { return SD.cardType(); }
+static uint64_t spiCardSize() { return SD.cardSize(); }
+
+// === SDMMC ===
+static bool sdmmcBegin() {
+  // DAT3 is the SPI chip select: high during CMD0 keeps the card in SD mode
+  pinMode(SD_CS, OUTPUT);
+  digitalWrite(SD_CS, HIGH);
+#if SDMMC_FOUR_BIT
+  if (!SD_MMC.setPins(SD_SCK, SD_MOSI, SD_MISO, SD_D1, SD_D2, SD_CS)) return false;
+  return SD_MMC.begin("/sdcard", false, false, LOG_SDMMC_FREQ_KHZ);
+#else
+  if (!SD_MMC.setPins(SD_SCK, SD_MOSI, SD_MISO)) return false;
+  return SD_MMC.begin("/sdcard", true, false, LOG_SDMMC_FREQ_KHZ);
+#endif
+}
+
+static void sdmmcEnd() {
+  SD_MMC.end();
+  releasePins();
+}
+
+static uint8_t sdmmcCardType() { return SD_MMC.cardType(); }
+static uint64_t sdmmcCardSize() { return SD_MMC.cardSize(); }
+
+static const StorageBackend spiBackend = {
+  "SPI", "/sd", SD, spiBegin, spiEnd, spiCardType, spiCardSize
+};
+static const StorageBackend sdmmcBackend = {
+  SDMMC_FOUR_BIT ? "SDMMC 4-bit" : "SDMMC 1-bit", "/sdcard", SD_MMC,
+  sdmmcBegin, sdmmcEnd, sdmmcCardType, sdmmcCardSize
+};
+
+// === Self-test ===
+uint32_t measureStorageWrite(const StorageBackend& backend) {
+  uint8_t* buffer = (uint8_t*)heap_caps_malloc(LOG_SELFTEST_CHUNK, MALLOC_CAP_SPIRAM);
+  if (!buffer) return 0;
+  for (size_t i = 0; i < LOG_SELFTEST_CHUNK; ++i) buffer[i] = (uint8_t)i;
+
+  uint32_t rate = 0;
+  if (File f = backend.fs.open(selfTestFile, FILE_WRITE)) {
+    size_t written = 0;
+    const uint32_t t0 = micros();
+    while (written < LOG_SELFTEST_BYTES &&
+           f.write(buffer, LOG_SELFTEST_CHUNK) == LOG_SELFTEST_CHUNK) {
+      written += LOG_SELFTEST_CHUNK;
+    }
+    f.flush();
+    const uint32_t us = micros() - t0;
+    f.close();
+    if (written == LOG_SELFTEST_BYTES && us > 0) {
+      rate = (uint32_t)((uint64_t)written * 1000000ULL / us);
+    }
+  }
+  backend.fs.remove(selfTestFile);
+  free(buffer);
+
+#if DEBUG_SD_BACKEND
+  Serial.printf("[SD] %s write test: %.2f MB/s\n", backend.name, rate / 1e6);
+#endif
+  return rate;
+}
+
+#if LOG_BACKEND == LOG_BACKEND_AUTO
+// Bus picked by the first mount of this boot that reached the card; later
+// mounts (the logger's retries, recovery, hot-insert) reuse it untested
+static const StorageBackend* bootBackend = nullptr;
+
+static uint32_t readSpiRate(fs::FS& fs) {
+  File f = fs.open(busFile, FILE_READ);
+  if (!f) return 0;
+  const long v = f.readString().toInt();
+  f.close();
+  return v > 0 ? (uint32_t)v : 0;
+}
+
+static void saveSpiRate(fs::FS& fs, uint32_t rate) {
+  if (File f = fs.open(busFile, FILE_WRITE)) {
+    f.printf("%lu\n", (unsigned long)rate);
+    f.close();
+  }
+}
+#endif
+
+// === Mount ===
+const StorageBackend* mountStorage() {
+#if LOG_BACKEND == LOG_BACKEND_SPI
+  return spiBackend.begin() ? &spiBackend : nullptr;
+#elif LOG_BACKEND == LOG_BACKEND_SDMMC
+  return sdmmcBackend.begin() ? &sdmmcBackend : nullptr;
+#else
+  if (bootBackend) {
+    if (bootBackend->begin()) return bootBackend;
+    // The formatter (SdFat over SPI) or a card swapped in while on SPI
+    // leaves the card in SPI mode: SDMMC cannot reach it until power-up
+    if (bootBackend != &sdmmcBackend || !spiBackend.begin()) return nullptr;
+    Serial.printf("[SD] %s mount failed — card in SPI mode, staying on SPI\n", sdmmcBackend.name);
+    bootBackend = &spiBackend;
+    return bootBackend;
+  }
+
+  uint32_t spiRate = 0;
+  const bool mmcMounted = sdmmcBackend.begin();
+  if (mmcMounted) {
+    const uint32_t mmcRate = measureStorageWrite(sdmmcBackend);
+    spiRate = readSpiRate(sdmmcBackend.fs);
+    if (mmcRate > 0 && spiRate > 0 && mmcRate >= spiRate) {
+      Serial.printf("[SD] Bus: %s (%.2f MB/s, SPI %.2f MB/s)\n",
+                    sdmmcBackend.name, mmcRate / 1e6, spiRate / 1e6);
+      bootBackend = &sdmmcBackend;
+      return bootBackend;
+    }
+    // Slower, failed the test, or SPI not measured on this card yet (then
+    // the card stays in SPI mode until the next power cycle)
+    sdmmcBackend.end();
+  } else {
+#if DEBUG_SD_BACKEND
+    Serial.println("[SD] SDMMC mount failed (not wired, or card in SPI mode since power-up)");
+#endif
+  }
+
+  if (!spiBackend.begin()) {
+    if (mmcMounted) bootBackend = &sdmmcBackend;   // tested already: retries go through the fallback above
+    return nullptr;
+  }
+  if (spiRate == 0) spiRate = readSpiRate(spiBackend.fs);
+  if (spiRate == 0) {
+    spiRate = measureStorageWrite(spiBackend);
+    if (spiRate > 0) saveSpiRate(spiBackend.fs, spiRate);
+  }
+  Serial.printf("[SD] Bus: %s (%.2f MB/s)\n", spiBackend.name, spiRate / 1e6);
+  bootBackend = &spiBackend;
+  return bootBackend;
+#endif
+}
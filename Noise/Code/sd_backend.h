@@ -0,0 +1,51 @@
+#pragma once
+
+#include <Arduino.h>
+#include <FS.h>
+
+// === Optional compile-time debug ===
+#define DEBUG_SD_BACKEND true
+
+// === Card bus behind the FFT logger ===
+// Either backend mounts the card's FAT volume through the VFS and hands
+// fft_logger.cpp an fs::FS, so log files, LOGH headers and index files are the
+// same on both buses and a card moves between builds unchanged.
+// SPI:   SD.begin(SD_CS, SPI, 25 MHz), roughly 2–3 MB/s sustained
+// SDMMC: SD_MMC on the same socket, 1-bit, or 4-bit with SD_D1/SD_D2 wired
+// AUTO:  a timed LOG_SELFTEST_BYTES write at mount picks the faster bus.
+//        A card that has seen SPI stays in SPI mode until it is power-cycled,
+//        so SDMMC is always tried first; the SPI rate is measured once and
+//        kept on the card (/log_bus.txt) for the following boots.
+#define LOG_BACKEND_SPI    0
+#define LOG_BACKEND_SDMMC  1
+#define LOG_BACKEND_AUTO   2
+#ifndef LOG_BACKEND
+#define LOG_BACKEND LOG_BACKEND_AUTO
+#endif
+#define LOG_SPI_FREQ_HZ     25000000
+#ifndef LOG_SDMMC_FREQ_KHZ
+#define LOG_SDMMC_FREQ_KHZ  40000             // high speed; 20000 for long or marginal wiring
+#endif
+#define LOG_SELFTEST_BYTES  (512UL * 1024UL)
+#define LOG_SELFTEST_CHUNK  (32UL * 1024UL)   // bytes per write() during the test
+
+struct StorageBackend {
+  const char* name;
+  const char* mountPoint;   // VFS prefix, for ESP-IDF calls on log paths
+  fs::FS& fs;
+  bool (*begin)();
+  void (*end)();            // unmount and leave the pins released
+  uint8_t (*cardType)();
+  uint64_t (*cardSize)();
+};
+
+// === Mount / unmount ===
+// Mounts the LOG_BACKEND bus; nullptr if no bus brings the card up. AUTO runs
+// the self-test at the first successful mount of a boot only and then keeps
+// that bus. Call end() of the returned backend to release it.
+const StorageBackend* mountStorage();
+
+// === Self-test ===
+// Sequential write rate of the mounted backend in bytes/s (0 on failure).
+// The test file is removed afterwards.
+uint32_t measureStorageWrite(const StorageBackend& backend);
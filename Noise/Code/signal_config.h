@@ -5,10 +5,23 @@
 #define RECORD_MS       500                // 500 ms recording
 #define TOTAL_SAMPLES   ((SAMPLE_RATE * RECORD_MS) / 1000)
 #define ADC_CHANNEL     ADC_CHANNEL_7      // Your actual ADC channel (e.g., GPIO8)
+#define ADC_RAW_CODES   4096               // 12-bit conversions → calibration table size
+
+// ==== CAPTURE MODE ====
+#define CAPTURE_MODE_BURST       0         // start/stop every cycle, RECORD_MS per CYCLE_PERIOD_MS
+#define CAPTURE_MODE_CONTINUOUS  1         // ADC runs free into a PSRAM hop ring, 100% coverage
+#ifndef CAPTURE_MODE
+#define CAPTURE_MODE    CAPTURE_MODE_BURST
+#endif
+#define CAPTURE_RING_HOPS   32             // ring depth in FFT_STEP_SIZE hops (~1.5 s at 2048/44.1 kHz)
 
 // ==== FFT ====
+#ifndef FFT_SIZE
 #define FFT_SIZE 4096
+#endif
+#ifndef FFT_STEP_SIZE
 #define FFT_STEP_SIZE 2048  // keep 50% overlap
+#endif
 #define FFT_BINS        (FFT_SIZE / 2)
 #define MAGNITUDE_THRESHOLD  0.010f        // Minimum valid magnitude (suppress noise)
 #define MV_TO_V_SCALE   1000.0f
@@ -18,6 +31,14 @@
 #define SD_SCK   36
 #define SD_MISO  37
 #define SD_MOSI  35
+// Same socket in SD mode (sd_backend.cpp): CLK = SD_SCK, CMD = SD_MOSI,
+// D0 = SD_MISO, D3 = SD_CS. Wire D1/D2 and set them here for 4-bit transfers.
+#ifndef SD_D1
+#define SD_D1    -1
+#endif
+#ifndef SD_D2
+#define SD_D2    -1
+#endif
 
 // ==== BUTTON AND TFT ====
 #define BUTTON_PIN 6
@@ -0,0 +1,92 @@
+#include "spectrum_codec.h"
+
+#include <math.h>
+#include <string.h>
+
+uint16_t floatToHalf(float value) {
+  uint32_t x;
+  memcpy(&x, &value, sizeof(x));
+  const uint16_t sign = (uint16_t)((x >> 16) & 0x8000u);
+  const uint32_t absX = x & 0x7FFFFFFFu;
+
+  if (absX >= 0x7F800000u) return sign | (absX > 0x7F800000u ? 0x7E00u : 0x7C00u);   // NaN / inf
+  if (absX >= 0x477FF000u) return sign | 0x7C00u;                                     // rounds past 65504
+  if (absX >= 0x38800000u) {
+    // Normal half: rebias the exponent, round the 13 dropped mantissa bits to even
+    const uint32_t rebased = absX - 0x38000000u;
+    const uint32_t roundBit = (rebased >> 13) & 1u;
+    return sign | (uint16_t)((rebased + 0x0FFFu + roundBit) >> 13);
+  }
+  if (absX < 0x33000000u) return sign;                                                // under half a subnormal step
+  // Subnormal half: shift the full mantissa into place, round to even
+  const uint32_t exponent = absX >> 23;
+  const uint32_t mantissa = (absX & 0x007FFFFFu) | 0x00800000u;
+  const uint32_t shift = 126u - exponent;                                             // 14..24
+  const uint32_t halfway = 1u << (shift - 1);
+  const uint32_t rest = mantissa & ((1u << shift) - 1u);
+  uint32_t h = mantissa >> shift;
+  if (rest > halfway || (rest == halfway && (h & 1u))) h++;
+  return sign | (uint16_t)h;
+}
+
+float halfToFloat(uint16_t half) {
+  const uint32_t sign = (uint32_t)(half & 0x8000u) << 16;
+  const uint32_t exponent = (half >> 10) & 0x1Fu;
+  const uint32_t mantissa = half & 0x03FFu;
+  uint32_t x;
+  if (exponent == 0x1Fu) {
+    x = sign | 0x7F800000u | (mantissa << 13);
+  } else if (exponent != 0) {
+    x = sign | ((exponent + 112u) << 23) | (mantissa << 13);
+  } else {
+    // Subnormal (or zero): exact in float
+    const float f = (float)mantissa * 5.9604645e-8f;   // 2^-24
+    return sign ? -f : f;
+  }
+  float f;
+  memcpy(&f, &x, sizeof(f));
+  return f;
+}
+
+size_t encodedSpectrumBytes(size_t bins, uint8_t encoding) {
+  return encoding == FFT3_ENC_F16 ? bins * sizeof(uint16_t) : bins;
+}
+
+float encodeSpectrum(const float* values, size_t bins, uint8_t encoding, uint8_t* out) {
+  float scale = 0.0f;
+  for (size_t i = 0; i < bins; ++i) scale = fmaxf(scale, values[i]);
+  if (scale <= 0.0f) {
+    memset(out, 0, encodedSpectrumBytes(bins, encoding));
+    return 0.0f;
+  }
+
+  const float inv = 1.0f / scale;
+  if (encoding == FFT3_ENC_F16) {
+    for (size_t i = 0; i < bins; ++i) {
+      const uint16_t h = floatToHalf(values[i] * inv);
+      memcpy(out + 2 * i, &h, sizeof(h));
+    }
+  } else {
+    const float codesPerLog10 = 20.0f / FFT3_LOG8_STEP_DB;
+    for (size_t i = 0; i < bins; ++i) {
+      const float v = values[i] * inv;
+      float code = v > 0.0f ? 255.0f + roundf(codesPerLog10 * log10f(v)) : 0.0f;
+      out[i] = (uint8_t)(code < 1.0f ? 0.0f : code);
+    }
+  }
+  return scale;
+}
+
+void decodeSpectrum(const uint8_t* in, size_t bins, uint8_t encoding, float scale, float* out) {
+  if (encoding == FFT3_ENC_F16) {
+    for (size_t i = 0; i < bins; ++i) {
+      uint16_t h;
+      memcpy(&h, in + 2 * i, sizeof(h));
+      out[i] = halfToFloat(h) * scale;
+    }
+  } else {
+    for (size_t i = 0; i < bins; ++i) {
+      out[i] = in[i] ? scale * powf(10.0f, ((float)in[i] - 255.0f) * FFT3_LOG8_STEP_DB / 20.0f) : 0.0f;
+    }
+  }
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// === Compact spectrum encodings (FFT3 log records) ===
+// Values are stored relative to the frame's largest value (the scale):
+//   F16:  IEEE half of value / scale, 2 bytes per bin (~0.05% error)
+//   LOG8: 8-bit code, 0 = zero or more than 127 dB under the scale, otherwise
+//         value = scale * 10^((code - 255) * FFT3_LOG8_STEP_DB / 20), 1 byte
+//         per bin (within ±FFT3_LOG8_STEP_DB / 2 dB)
+// F16 keeps the host's recomputed features within 0.03%; LOG8 halves the
+// record again but moves them by up to ~2% and flips peak counts near the
+// 1.5x-mean threshold (fft_bench --codec)
+#define FFT3_ENC_F16      0
+#define FFT3_ENC_LOG8     1
+#ifndef FFT3_ENCODING
+#define FFT3_ENCODING     FFT3_ENC_F16
+#endif
+#define FFT3_LOG8_STEP_DB 0.5f
+
+size_t encodedSpectrumBytes(size_t bins, uint8_t encoding);
+// Writes encodedSpectrumBytes() bytes to out; returns the scale to store with them
+float encodeSpectrum(const float* values, size_t bins, uint8_t encoding, uint8_t* out);
+void decodeSpectrum(const uint8_t* in, size_t bins, uint8_t encoding, float scale, float* out);
+
+uint16_t floatToHalf(float value);   // round to nearest even, saturates to inf
+float halfToFloat(uint16_t half);
@@ -0,0 +1,201 @@
+#include "task_placement.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_timer.h"
+#include "esp_idf_version.h"
+#include "nvs_flash.h"
+#include "nvs.h"
+
+#define PLACEMENT_CORES 2
+
+// ---- NVS keys (one u8 per task, same order as PipelineTask) ----
+static const char* NVS_NS = "placement";
+static const char* const TASK_NAMES[] = { "sampler", "fft", "logger", "battery", "fft_lane" };
+static_assert(sizeof(TASK_NAMES) / sizeof(TASK_NAMES[0]) == (size_t)PipelineTask::COUNT,
+              "TASK_NAMES must cover every PipelineTask");
+
+static uint8_t placement[(size_t)PipelineTask::COUNT] = {
+  CORE_SAMPLER, CORE_FFT, CORE_LOGGER, CORE_BATTERY, CORE_FFT_LANE
+};
+static bool fromNVS[(size_t)PipelineTask::COUNT] = {};
+
+// ---- Run-time accounting ----
+#define CORE_LOAD_AVAILABLE (configGENERATE_RUN_TIME_STATS && configUSE_TRACE_FACILITY)
+#ifndef configRUN_TIME_COUNTER_TYPE
+#define configRUN_TIME_COUNTER_TYPE uint32_t
+#endif
+typedef configRUN_TIME_COUNTER_TYPE RunTime;   // wraps; only differences are used
+
+static portMUX_TYPE loadMux = portMUX_INITIALIZER_UNLOCKED;
+static TaskHandle_t taskHandles[(size_t)PipelineTask::COUNT] = {};
+static int64_t loadWindowStartUs = 0;
+#if CORE_LOAD_AVAILABLE
+static RunTime lastTaskRun[(size_t)PipelineTask::COUNT] = {};
+static RunTime lastIdleRun[PLACEMENT_CORES] = {};
+static RunTime lastTotalRun = 0;
+#endif
+
+static bool validCore(uint8_t core) {
+  return core < PLACEMENT_CORES || core == PLACEMENT_ANY_CORE;
+}
+
+static bool placementNvsInit() {
+  esp_err_t err = nvs_flash_init();
+  if (err == ESP_ERR_NVS_NO_FREE_PAGES || err == ESP_ERR_NVS_NEW_VERSION_FOUND) {
+    ESP_ERROR_CHECK(nvs_flash_erase());
+    err = nvs_flash_init();
+  }
+  return err == ESP_OK;
+}
+
+void loadTaskPlacement() {
+  loadWindowStartUs = esp_timer_get_time();
+  if (!placementNvsInit()) {
+    Serial.println("[CORE] NVS unavailable — using compile-time placement");
+    return;
+  }
+
+  nvs_handle_t h;
+  if (nvs_open(NVS_NS, NVS_READONLY, &h) != ESP_OK) return;   // no overrides stored yet
+  for (size_t i = 0; i < (size_t)PipelineTask::COUNT; ++i) {
+    uint8_t core = 0;
+    if (nvs_get_u8(h, TASK_NAMES[i], &core) != ESP_OK) continue;
+    if (!validCore(core)) {
+      Serial.printf("[CORE] Ignoring NVS placement %s=%u\n", TASK_NAMES[i], core);
+      continue;
+    }
+    placement[i] = core;
+    fromNVS[i] = true;
+  }
+  nvs_close(h);
+}
+
+BaseType_t getTaskCore(PipelineTask task) {
+  uint8_t core = placement[(size_t)task];
+  return (core == PLACEMENT_ANY_CORE) ? tskNO_AFFINITY : (BaseType_t)core;
+}
+
+bool setTaskPlacementOverride(PipelineTask task, uint8_t core) {
+  if (task >= PipelineTask::COUNT || !validCore(core) || !placementNvsInit()) return false;
+  nvs_handle_t h;
+  if (nvs_open(NVS_NS, NVS_READWRITE, &h) != ESP_OK) return false;
+  bool ok = nvs_set_u8(h, TASK_NAMES[(size_t)task], core) == ESP_OK && nvs_commit(h) == ESP_OK;
+  nvs_close(h);
+  return ok;
+}
+
+bool clearTaskPlacementOverrides() {
+  if (!placementNvsInit()) return false;
+  nvs_handle_t h;
+  if (nvs_open(NVS_NS, NVS_READWRITE, &h) != ESP_OK) return false;
+  bool ok = nvs_erase_all(h) == ESP_OK && nvs_commit(h) == ESP_OK;
+  nvs_close(h);
+  return ok;
+}
+
+const char* pipelineTaskName(PipelineTask task) {
+  return (task < PipelineTask::COUNT) ? TASK_NAMES[(size_t)task] : "?";
+}
+
+void printTaskPlacement() {
+  for (size_t i = 0; i < (size_t)PipelineTask::COUNT; ++i) {
+    if (placement[i] == PLACEMENT_ANY_CORE) {
+      Serial.printf("[CORE] %-8s → any core%s\n", TASK_NAMES[i], fromNVS[i] ? " (NVS)" : "");
+    } else {
+      Serial.printf("[CORE] %-8s → core %u%s\n", TASK_NAMES[i], placement[i], fromNVS[i] ? " (NVS)" : "");
+    }
+  }
+}
+
+void registerPipelineTask(PipelineTask task, TaskHandle_t handle) {
+  if (task >= PipelineTask::COUNT || !handle) return;
+  portENTER_CRITICAL(&loadMux);
+  taskHandles[(size_t)task] = handle;
+  portEXIT_CRITICAL(&loadMux);
+}
+
+#if CORE_LOAD_AVAILABLE
+static TaskHandle_t idleTaskHandle(BaseType_t core) {
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 3, 0)
+  return xTaskGetIdleTaskHandleForCore(core);
+#else
+  return xTaskGetIdleTaskHandleForCPU((UBaseType_t)core);
+#endif
+}
+
+static const TaskStatus_t* findTask(const TaskStatus_t* status, UBaseType_t count, TaskHandle_t handle) {
+  for (UBaseType_t i = 0; i < count; ++i) {
+    if (status[i].xHandle == handle) return &status[i];
+  }
+  return nullptr;
+}
+#endif
+
+void printCoreLoad() {
+#if CORE_LOAD_AVAILABLE
+  // Room for a few tasks created between the count and the snapshot
+  const UBaseType_t capacity = uxTaskGetNumberOfTasks() + 4;
+  TaskStatus_t* status = (TaskStatus_t*)malloc(capacity * sizeof(TaskStatus_t));
+  if (!status) return;
+  RunTime total = 0;
+  const UBaseType_t count = uxTaskGetSystemState(status, capacity, &total);
+  if (count == 0) {
+    free(status);
+    return;
+  }
+
+  TaskHandle_t handles[(size_t)PipelineTask::COUNT];
+  portENTER_CRITICAL(&loadMux);
+  memcpy(handles, taskHandles, sizeof(handles));
+  portEXIT_CRITICAL(&loadMux);
+
+  const RunTime window = total - lastTotalRun;
+  lastTotalRun = total;
+  const int64_t now = esp_timer_get_time();
+  const double windowS = (now - loadWindowStartUs) / 1e6;
+  loadWindowStartUs = now;
+  if (window == 0) {
+    free(status);
+    return;
+  }
+
+  // Per core: everything but its idle task (light sleep included in idle)
+  double coreLoad[PLACEMENT_CORES];
+  for (BaseType_t core = 0; core < PLACEMENT_CORES; ++core) {
+    const TaskStatus_t* idle = findTask(status, count, idleTaskHandle(core));
+    const RunTime run = idle ? idle->ulRunTimeCounter : lastIdleRun[core];
+    const double idleShare = (double)(RunTime)(run - lastIdleRun[core]) / window;
+    lastIdleRun[core] = run;
+    coreLoad[core] = 100.0 * (idleShare < 1.0 ? 1.0 - idleShare : 0.0);
+  }
+
+  Serial.printf("[CORE] load over %.1f s: core0=%.1f%% core1=%.1f%% |",
+                windowS, coreLoad[0], coreLoad[1]);
+  for (size_t i = 0; i < (size_t)PipelineTask::COUNT; ++i) {
+    if (!handles[i]) continue;   // not created in this build
+    const TaskStatus_t* t = findTask(status, count, handles[i]);
+    RunTime run = 0;
+    int core = placement[i];
+    if (t) {
+      run = (RunTime)(t->ulRunTimeCounter - lastTaskRun[i]);
+      lastTaskRun[i] = t->ulRunTimeCounter;
+#if configTASKLIST_INCLUDE_COREID
+      core = (t->xCoreID == tskNO_AFFINITY) ? PLACEMENT_ANY_CORE : (int)t->xCoreID;
+#endif
+    }
+    if (core == PLACEMENT_ANY_CORE) {
+      Serial.printf(" %s=%.1f%%@any", TASK_NAMES[i], 100.0 * run / window);
+    } else {
+      Serial.printf(" %s=%.1f%%@%d", TASK_NAMES[i], 100.0 * run / window, core);
+    }
+  }
+  Serial.println();
+  free(status);
+#else
+  static bool warned = false;
+  if (!warned) {
+    Serial.println("[CORE] load needs CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS and CONFIG_FREERTOS_USE_TRACE_FACILITY");
+    warned = true;
+  }
+#endif
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <Arduino.h>
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+// === Optional compile-time debug ===
+#define DEBUG_TASK_PLACEMENT false
+
+// === Pipeline tasks ===
+enum class PipelineTask : uint8_t {
+  SAMPLER,
+  FFT,
+  LOGGER,
+  BATTERY,
+  FFT_LANE,      // odd FFT windows (FFT_PARALLEL lane worker)
+  COUNT
+};
+
+// === Compile-time placement (overridable per kit from NVS) ===
+// 0 / 1 = pin to that core, PLACEMENT_ANY_CORE = let the scheduler choose.
+// Core 0 also runs the BLE controller; core 1 the Arduino loop (deleted in setup()).
+#define PLACEMENT_ANY_CORE 0xFF
+#ifndef CORE_SAMPLER
+#define CORE_SAMPLER 0
+#endif
+#ifndef CORE_FFT
+#define CORE_FFT     1
+#endif
+#ifndef CORE_LOGGER
+#define CORE_LOGGER  0
+#endif
+#ifndef CORE_BATTERY
+#define CORE_BATTERY 0
+#endif
+#ifndef CORE_FFT_LANE
+#define CORE_FFT_LANE 0   // the core FFT is not on, so both lanes run at once
+#endif
+
+// === Placement table ===
+void loadTaskPlacement();                               // Defaults, then NVS "placement" overrides
+BaseType_t getTaskCore(PipelineTask task);              // Ready for xTaskCreatePinnedToCore()
+bool setTaskPlacementOverride(PipelineTask task, uint8_t core);   // Persisted; applies from next boot
+bool clearTaskPlacementOverrides();
+const char* pipelineTaskName(PipelineTask task);
+void printTaskPlacement();
+
+// === Per-core utilization ===
+// From FreeRTOS run-time stats (CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS): a
+// core's load is the time its idle task did not run, a pipeline task's the run
+// time of its FreeRTOS tasks. Preemption and blocking are not counted, and
+// automatic light sleep is entered from the idle task, so it counts as idle.
+void registerPipelineTask(PipelineTask task, TaskHandle_t handle);   // Tasks never registered are not printed
+void printCoreLoad();                                   // Load % per core and task since the last call
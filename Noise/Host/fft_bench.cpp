@@ -0,0 +1,746 @@
+// Host replay benchmark for fft_engine.cpp.
+//
+// Feeds recorded captures through the engine and reports throughput plus a
+// per-stage breakdown. Raw uint16 ADC dumps of the sampler buffer go through
+// processFFTRaw() exactly as fftTask does on the device, with a linear
+// calibration table standing in for the ADC curve; 16-bit PCM WAV files (as
+// served by getLastWAV()) go through processFFT() as mV.
+//
+//   fft_bench [options] capture.wav|capture.raw ...
+//
+//   --raw              treat every input as raw little-endian uint16 ADC codes
+//   --capture N        samples per processFFT() call (default TOTAL_SAMPLES)
+//   --stream           push hops continuously (pushHop()/finalizeFrame()), one
+//                      frame per --capture samples, windows spanning frame edges
+//   --repeat N         replay the whole input set N times (default 1)
+//   --jobs N           replay inputs on N threads, one FFTEngine per input
+//                      (default 1: every input through the default engine)
+//   --adc-fs-mv MV     mV at ADC code 4095 for raw dumps (default 3100)
+//   --wav-fs-mv MV     mV at PCM full scale for WAV input (default 1000)
+//   --wav-bias-mv MV   DC bias added to WAV input in mV (default 1650)
+//   --frames           print per-frame features (and quiet-gate level) as CSV
+//                      on stdout
+//   --dump FILE        write every pooled spectrum (first pass) to FILE
+//   --level            also feed the level meter (level_meter.cpp) with the
+//                      engine's A-weighted window powers, as fftTask does;
+//                      reports its cost (the engine's level stage plus the
+//                      meter) and, with --frames, the per-second records
+//                      (needs --stream and --jobs 1). Each frame's level
+//                      also feeds the L10/L50/L90 statistics (level_stats.cpp),
+//                      timed by audio position; [LSTAT] lists the summaries
+//   --minutes          accumulate the on-device minute summaries
+//                      (minute_summary.cpp), timed by audio position, and
+//                      print them as CSV with the host aggregation's column
+//                      names (needs --jobs 1)
+//   --check            regression check: recompute each frame's features with
+//                      the reference (three-pass, logf) extraction and fail if
+//                      the engine's fused pass drifts past the tolerances
+//   --codec            encode every pooled spectrum as an FFT3 record would
+//                      (spectrum_codec.cpp, float16 and 8-bit log-dB), decode
+//                      it and report the record size and how far the decoded
+//                      spectrum's reference features drift
+//   --verbose          keep firmware Serial output (stderr)
+//
+//   fft_bench --compare A.dump B.dump
+//
+//   Bin-for-bin comparison of two --dump files, e.g. FFT_BACKEND=REAL
+//   against FFT_BACKEND=ARDUINOFFT builds over the same captures.
+
+#include "Arduino.h"
+#include "signal_config.h"
+#include "fft_engine.h"
+#include "level_meter.h"
+#include "level_stats.h"
+#include "minute_summary.h"
+#include "spectrum_codec.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// === Capture loading ===
+
+struct Capture {
+  std::string name;
+  std::vector<float> mv;      // WAV input: samples in mV, as convertRawToMV() produces
+  std::vector<uint16_t> raw;  // raw input: ADC codes, as getReadySamples() holds
+
+  size_t size() const { return raw.empty() ? mv.size() : raw.size(); }
+};
+
+static bool readFile(const char* path, std::vector<uint8_t>& out) {
+  FILE* f = fopen(path, "rb");
+  if (!f) return false;
+  fseek(f, 0, SEEK_END);
+  long sz = ftell(f);
+  fseek(f, 0, SEEK_SET);
+  out.resize(sz > 0 ? (size_t)sz : 0);
+  size_t got = out.empty() ? 0 : fread(out.data(), 1, out.size(), f);
+  fclose(f);
+  return got == out.size();
+}
+
+static uint32_t rd32(const uint8_t* p) { uint32_t v; memcpy(&v, p, 4); return v; }
+static uint16_t rd16(const uint8_t* p) { uint16_t v; memcpy(&v, p, 2); return v; }
+
+static bool loadWAV(const std::vector<uint8_t>& buf, float fsMv, float biasMv, Capture& cap) {
+  if (buf.size() < 12 || memcmp(buf.data(), "RIFF", 4) != 0 || memcmp(buf.data() + 8, "WAVE", 4) != 0) {
+    return false;
+  }
+  uint16_t channels = 0, bits = 0;
+  uint32_t rate = 0;
+  size_t pos = 12;
+  while (pos + 8 <= buf.size()) {
+    const uint8_t* ck = buf.data() + pos;
+    uint32_t len = rd32(ck + 4);
+    if (memcmp(ck, "fmt ", 4) == 0 && len >= 16) {
+      channels = rd16(ck + 10);
+      rate     = rd32(ck + 12);
+      bits     = rd16(ck + 22);
+    } else if (memcmp(ck, "data", 4) == 0) {
+      if (bits != 16 || channels == 0) {
+        fprintf(stderr, "[BENCH] %s: only 16-bit PCM WAV supported\n", cap.name.c_str());
+        return false;
+      }
+      if (rate != SAMPLE_RATE) {
+        fprintf(stderr, "[BENCH] %s: WAV rate %u Hz != SAMPLE_RATE %u Hz (not resampled)\n",
+                cap.name.c_str(), (unsigned)rate, (unsigned)SAMPLE_RATE);
+      }
+      size_t avail = std::min<size_t>(len, buf.size() - pos - 8);
+      size_t frames = avail / (2u * channels);
+      const uint8_t* pcm = ck + 8;
+      cap.mv.resize(frames);
+      for (size_t i = 0; i < frames; ++i) {
+        int16_t s = (int16_t)rd16(pcm + i * 2u * channels);   // first channel only
+        cap.mv[i] = biasMv + ((float)s / 32767.0f) * fsMv;
+      }
+      return true;
+    }
+    pos += 8 + len + (len & 1u);
+  }
+  fprintf(stderr, "[BENCH] %s: no data chunk\n", cap.name.c_str());
+  return false;
+}
+
+static void loadRaw(const std::vector<uint8_t>& buf, Capture& cap) {
+  size_t n = buf.size() / 2;
+  cap.raw.resize(n);
+  for (size_t i = 0; i < n; ++i) {
+    cap.raw[i] = rd16(buf.data() + i * 2);
+  }
+}
+
+// === Spectrum dumps ===
+// "MKD1", uint32 bins, then one float32[bins] pooled spectrum per frame.
+
+static FILE* openDump(const char* path, uint32_t bins) {
+  FILE* f = fopen(path, "wb");
+  if (!f) return nullptr;
+  fwrite("MKD1", 1, 4, f);
+  fwrite(&bins, sizeof(bins), 1, f);
+  return f;
+}
+
+static bool loadDump(const char* path, uint32_t& bins, std::vector<float>& data) {
+  std::vector<uint8_t> buf;
+  if (!readFile(path, buf) || buf.size() < 8 || memcmp(buf.data(), "MKD1", 4) != 0) return false;
+  bins = rd32(buf.data() + 4);
+  if (bins == 0) return false;
+  size_t n = (buf.size() - 8) / sizeof(float);
+  n -= n % bins;
+  data.resize(n);
+  memcpy(data.data(), buf.data() + 8, n * sizeof(float));
+  return true;
+}
+
+static int compareDumps(const char* pathA, const char* pathB) {
+  uint32_t binsA = 0, binsB = 0;
+  std::vector<float> a, b;
+  if (!loadDump(pathA, binsA, a) || !loadDump(pathB, binsB, b)) {
+    fprintf(stderr, "[BENCH] cannot load dumps\n");
+    return 1;
+  }
+  if (binsA != binsB || a.size() != b.size()) {
+    fprintf(stderr, "[BENCH] dump shape mismatch (%u vs %u bins, %zu vs %zu values)\n",
+            binsA, binsB, a.size(), b.size());
+    return 1;
+  }
+
+  size_t frames = a.size() / binsA;
+  double maxAbs = 0.0, maxRelPeak = 0.0;
+  size_t worstFrame = 0, worstBin = 0;
+  for (size_t f = 0; f < frames; ++f) {
+    const float* fa = a.data() + f * binsA;
+    const float* fb = b.data() + f * binsA;
+    float peak = 0.0f;
+    for (uint32_t k = 0; k < binsA; ++k) peak = std::max(peak, std::max(fa[k], fb[k]));
+    for (uint32_t k = 0; k < binsA; ++k) {
+      double d = fabs((double)fa[k] - (double)fb[k]);
+      double rel = peak > 0.0f ? d / peak : 0.0;
+      if (d > maxAbs) maxAbs = d;
+      if (rel > maxRelPeak) { maxRelPeak = rel; worstFrame = f; worstBin = k; }
+    }
+  }
+  printf("[COMPARE] frames=%zu bins=%u max|a-b|=%.3g max|a-b|/peak=%.3g (%.1f dB) at frame %zu bin %zu\n",
+         frames, binsA, maxAbs, maxRelPeak,
+         maxRelPeak > 0.0 ? 20.0 * log10(maxRelPeak) : -INFINITY, worstFrame, worstBin);
+  return 0;
+}
+
+// === Replay ===
+
+// === Reference features (--check) ===
+// The three-pass extraction with logf() that the fused feature pass replaced,
+// recomputed from the pooled spectrum the engine just finalized.
+
+#define CHECK_TOL_EXACT  1e-6   // energy, SNR, contrast: same sums, same order
+#define CHECK_TOL_SFM    1e-5   // fastLogf() against logf(), see fft_engine.cpp
+
+struct RefFeatures {
+  float energy, snr, contrast, sfm;
+  int peaks;
+};
+
+static RefFeatures referenceFeatures(const float* mags) {
+  using S = FFTEngine::Spec;
+  const float eps = 1e-9f;
+  float voiceEnergy = 0.0f, noiseEnergy = 0.0f, maxVoice = 0.0f, meanVoice = 0.0f;
+  for (size_t i = 0; i < S::bins; ++i) {
+    float m = mags[i];
+    if (i >= S::minVoiceBin && i <= S::maxVoiceBin) {
+      voiceEnergy += m * m;
+      meanVoice += m;
+      if (m > maxVoice) maxVoice = m;
+    } else {
+      noiseEnergy += m * m;
+    }
+  }
+  const size_t bandBins = S::maxVoiceBin - S::minVoiceBin + 1;
+  meanVoice /= (float)bandBins;
+
+  RefFeatures ref = {};
+  ref.energy = voiceEnergy;
+  ref.contrast = meanVoice > 0.0f ? maxVoice / meanVoice : 0.0f;
+  for (size_t i = S::minVoiceBin; i <= S::maxVoiceBin; ++i) {
+    if (mags[i] > meanVoice * 1.5f) ref.peaks++;
+  }
+
+  float bandRMS = 0.0f, noiseRMS = 0.0f, bandSum = 0.0f, logSum = 0.0f;
+  size_t noiseBins = 0;
+  for (size_t i = 0; i < S::bins; ++i) {
+    float m = mags[i];
+    if (i >= S::minVoiceBin && i <= S::maxVoiceBin) {
+      bandRMS += m * m;
+      bandSum += m;
+      logSum += logf(m + eps);
+    } else {
+      noiseRMS += m * m;
+      noiseBins++;
+    }
+  }
+  bandRMS = sqrtf(bandRMS / (float)bandBins);
+  noiseRMS = noiseBins > 0 ? sqrtf(noiseRMS / (float)noiseBins) : 0.0f;
+  ref.snr = noiseRMS > 0.0f ? (bandRMS * bandRMS) / (noiseRMS * noiseRMS + eps) : 0.0f;
+  ref.sfm = expf(logSum / (float)bandBins) / (bandSum / (float)bandBins + eps);
+  return ref;
+}
+
+static double relDiff(float a, float b) {
+  double scale = std::max(fabs((double)a), fabs((double)b));
+  return scale > 0.0 ? fabs((double)a - (double)b) / scale : 0.0;
+}
+
+struct CheckResult {
+  uint64_t frames = 0;
+  uint64_t peakMismatches = 0;
+  double energy = 0.0, snr = 0.0, contrast = 0.0, sfm = 0.0;   // max relative difference
+
+  void merge(const CheckResult& o) {
+    frames += o.frames;
+    peakMismatches += o.peakMismatches;
+    energy = std::max(energy, o.energy);
+    snr = std::max(snr, o.snr);
+    contrast = std::max(contrast, o.contrast);
+    sfm = std::max(sfm, o.sfm);
+  }
+
+  void add(const RefFeatures& a, const RefFeatures& b) {
+    frames++;
+    energy = std::max(energy, relDiff(a.energy, b.energy));
+    snr = std::max(snr, relDiff(a.snr, b.snr));
+    contrast = std::max(contrast, relDiff(a.contrast, b.contrast));
+    sfm = std::max(sfm, relDiff(a.sfm, b.sfm));
+    if (a.peaks != b.peaks) peakMismatches++;
+  }
+};
+
+// === Spectrum codec (--codec) ===
+// FFT3 magnitudes go through spectrum_codec.cpp; the reference features of the
+// decoded spectrum are compared with those of the pooled one.
+
+static const uint8_t kCodecEncodings[] = { FFT3_ENC_F16, FFT3_ENC_LOG8 };
+#define CODEC_COUNT (sizeof(kCodecEncodings) / sizeof(kCodecEncodings[0]))
+
+struct CodecResult {
+  CheckResult drift;
+  double maxErr = 0.0;       // max |a-b| / frame peak
+
+  void merge(const CodecResult& o) {
+    drift.merge(o.drift);
+    maxErr = std::max(maxErr, o.maxErr);
+  }
+};
+
+static void codecFrame(const float* mags, size_t bins, CodecResult* out) {
+  std::vector<uint8_t> coded(encodedSpectrumBytes(bins, FFT3_ENC_F16));
+  std::vector<float> decoded(bins);
+  const RefFeatures ref = referenceFeatures(mags);
+  for (size_t e = 0; e < CODEC_COUNT; ++e) {
+    const float scale = encodeSpectrum(mags, bins, kCodecEncodings[e], coded.data());
+    decodeSpectrum(coded.data(), bins, kCodecEncodings[e], scale, decoded.data());
+    for (size_t i = 0; i < bins && scale > 0.0f; ++i) {
+      out[e].maxErr = std::max(out[e].maxErr, fabs((double)decoded[i] - (double)mags[i]) / scale);
+    }
+    out[e].drift.add(ref, referenceFeatures(decoded.data()));
+  }
+}
+
+// === Replay ===
+
+struct ReplayOptions {
+  bool stream;
+  size_t captureLen;
+  size_t frameHops;          // stream: hops pushed per frame
+  const float* rawToVolts;
+  bool keepSpectra;          // --dump
+  bool keepFrames;           // --frames
+  bool check;                // --check
+  bool level;                // --level
+  bool minutes;              // --minutes
+  bool codec;                // --codec
+};
+
+struct ReplayResult {
+  uint64_t frames = 0, windows = 0, voiceFrames = 0, quietFrames = 0, audioSamples = 0;
+  uint64_t wallNs = 0;
+  uint64_t latencyNs = 0;    // last sample of a frame in → features out
+  uint64_t levelNs = 0;      // level meter, kept out of wallNs
+  std::vector<LevelSecond> levels;
+  std::vector<LevelSummary> summaries;
+  std::vector<MinuteSummary> minutes;
+  std::vector<float> spectra;
+  std::string csv;
+  CheckResult check;
+  CodecResult codec[CODEC_COUNT];
+};
+
+// One pass of one capture through an engine. Spectra and CSV rows are kept on
+// the first pass only, so --jobs can emit them in input order afterwards.
+static void replayCapture(FFTEngine& eng, const Capture& cap, const ReplayOptions& opt,
+                          bool firstPass, ReplayResult& res) {
+  constexpr size_t step = FFTEngine::Spec::step;
+  size_t frameIdx = 0;
+  if (opt.stream) eng.beginFrame();
+  // Batch: one process*() per capture. Stream: frameHops pushes per frame,
+  // so the same number of samples per frame but every hop boundary windowed.
+  const size_t frameLen = opt.stream ? opt.frameHops * step : opt.captureLen;
+  for (size_t off = 0; off + frameLen <= cap.size(); off += frameLen, ++frameIdx) {
+    bool ok = false;
+    size_t frameWindows = 0;
+    uint64_t t0 = halNowNs();
+    if (opt.stream) {
+      auto push = [&](size_t h) {
+        if (cap.raw.empty()) eng.pushHopMV(cap.mv.data() + off + h * step);
+        else eng.pushHop(cap.raw.data() + off + h * step, opt.rawToVolts);
+      };
+      for (size_t h = 0; h + 1 < opt.frameHops; ++h) push(h);
+      uint64_t tLast = halNowNs();
+      res.wallNs += tLast - t0;      // earlier hops overlap capture on the device
+      t0 = tLast;
+      push(opt.frameHops - 1);
+      frameWindows = eng.getFrameWindows();
+      ok = eng.finalizeFrame();
+    } else {
+      ok = cap.raw.empty()
+             ? eng.process(cap.mv.data() + off, opt.captureLen)
+             : eng.processRaw(cap.raw.data() + off, opt.captureLen, opt.rawToVolts);
+      frameWindows = (opt.captureLen - FFTEngine::Spec::size) / step + 1;
+    }
+    uint64_t dt = halNowNs() - t0;
+    res.wallNs += dt;
+    res.latencyNs += dt;
+
+    if (opt.level) {
+      // The frame's window powers after finalizeFrame(), as fftTask feeds the meter
+      uint64_t tl = halNowNs();
+      float windowLevels[FFT_WINDOW_LEVELS];
+      levelMeterPushWindows(windowLevels, eng.drainWindowLevels(windowLevels, FFT_WINDOW_LEVELS));
+      res.levelNs += halNowNs() - tl;
+      LevelSecond secs[LEVEL_SECOND_QUEUE];
+      const size_t n = drainLevelSeconds(secs, LEVEL_SECOND_QUEUE, 0);
+      if (firstPass) res.levels.insert(res.levels.end(), secs, secs + n);
+    }
+    if (!ok) continue;
+
+    const FFTFeatures ft = eng.getFeatures();
+    res.frames++;
+    res.windows += frameWindows;
+    res.audioSamples += frameLen;
+    if (ft.voice) res.voiceFrames++;
+    if (ft.quiet) res.quietFrames++;
+
+    // Frame timestamps for the summaries: audio replayed so far
+    static uint64_t statsSamples = 0;
+    if (firstPass) statsSamples += frameLen;
+    const uint64_t audioTs = statsSamples / SAMPLE_RATE;
+    if (opt.level && firstPass) {
+      // Same choice of level as publishFFTFrame()
+      const float levelDB = isLevelMeterSettled() ? getLevelFastDB()
+                          : ft.quiet ? fmaxf(20.0f * log10f(ft.levelRMS) + LEVEL_DB_OFFSET, LEVEL_DB_FLOOR)
+                          : ft.laeqDB;
+      LevelSummary closed[2];
+      const size_t n = levelStatsPush(levelDB, audioTs, closed);
+      res.summaries.insert(res.summaries.end(), closed, closed + n);
+    }
+    if (opt.minutes && firstPass) {
+      MinuteSummary closed;
+      if (minuteSummaryPush(ft, audioTs, &closed)) res.minutes.push_back(closed);
+    }
+
+    if (opt.check && firstPass && !ft.quiet) {   // quiet frames have no spectrum to check
+      const RefFeatures ref = referenceFeatures(eng.getMagnitudes());
+      CheckResult& c = res.check;
+      c.frames++;
+      c.energy = std::max(c.energy, relDiff(ft.energy, ref.energy));
+      c.snr = std::max(c.snr, relDiff(ft.snr, ref.snr));
+      c.contrast = std::max(c.contrast, relDiff(ft.contrast, ref.contrast));
+      c.sfm = std::max(c.sfm, relDiff(eng.getSpectralFlatness(), ref.sfm));
+      if (ft.peakCount != ref.peaks) c.peakMismatches++;
+    }
+    if (opt.codec && firstPass && !ft.quiet) {
+      codecFrame(eng.getMagnitudes(), eng.getBins(), res.codec);
+    }
+    if (opt.keepSpectra && firstPass) {
+      res.spectra.insert(res.spectra.end(), eng.getMagnitudes(), eng.getMagnitudes() + eng.getBins());
+    }
+    if (opt.keepFrames && firstPass) {
+      float domMag = 0.0f;
+      float domHz = eng.getDominantFrequency(domMag);
+      char line[256];
+      snprintf(line, sizeof(line), "%s,%zu,%d,%.4f,%.6f,%d,%.4f,%.3f,%.1f,%d,%.6f,%.1f,%.2f\n",
+               cap.name.c_str(), frameIdx, ft.voice ? 1 : 0, ft.snr, ft.energy, ft.peakCount,
+               ft.contrast, ft.intensityDB, domHz, ft.quiet ? 1 : 0, ft.levelRMS, ft.zcrHz, ft.laeqDB);
+      res.csv += line;
+    }
+  }
+}
+
+static void addStageTimes(FFTStageTimes& acc, const FFTStageTimes& st) {
+  acc.inputNs     += st.inputNs;
+  acc.fftNs       += st.fftNs;
+  acc.magnitudeNs += st.magnitudeNs;
+  acc.poolNs      += st.poolNs;
+  acc.levelNs     += st.levelNs;
+  acc.featureNs   += st.featureNs;
+  acc.windows     += st.windows;
+  acc.frames      += st.frames;
+}
+
+static void addGateStats(QuietGateStats& acc, const QuietGateStats& gs) {
+  acc.windowsRun     += gs.windowsRun;
+  acc.windowsSkipped += gs.windowsSkipped;
+  acc.quietFrames    += gs.quietFrames;
+}
+
+// === Main ===
+
+static void usage() {
+  fprintf(stderr,
+    "usage: fft_bench [--raw] [--capture N] [--stream] [--repeat N] [--jobs N] [--adc-fs-mv MV]\n"
+    "                 [--wav-fs-mv MV] [--wav-bias-mv MV] [--frames] [--dump FILE]\n"
+    "                 [--level] [--minutes] [--check] [--codec] [--verbose] file...\n"
+    "       fft_bench --compare A.dump B.dump\n");
+}
+
+int main(int argc, char** argv) {
+  bool forceRaw = false, printFrames = false, verbose = false, stream = false, check = false;
+  bool level = false, minutes = false, codec = false;
+  size_t captureLen = TOTAL_SAMPLES;
+  unsigned repeat = 1, jobs = 1;
+  float adcFsMv = 3100.0f, wavFsMv = 1000.0f, wavBiasMv = 1650.0f;
+  const char* dumpPath = nullptr;
+  std::vector<const char*> inputs;
+
+  if (argc == 4 && strcmp(argv[1], "--compare") == 0) {
+    return compareDumps(argv[2], argv[3]);
+  }
+
+  for (int i = 1; i < argc; ++i) {
+    std::string a = argv[i];
+    auto next = [&](void) -> const char* {
+      if (i + 1 >= argc) { usage(); exit(2); }
+      return argv[++i];
+    };
+    if      (a == "--raw")         forceRaw = true;
+    else if (a == "--frames")      printFrames = true;
+    else if (a == "--verbose")     verbose = true;
+    else if (a == "--stream")      stream = true;
+    else if (a == "--check")       check = true;
+    else if (a == "--level")       level = true;
+    else if (a == "--minutes")     minutes = true;
+    else if (a == "--codec")       codec = true;
+    else if (a == "--capture")     captureLen = strtoul(next(), nullptr, 10);
+    else if (a == "--repeat")      repeat = (unsigned)strtoul(next(), nullptr, 10);
+    else if (a == "--jobs")        jobs = (unsigned)strtoul(next(), nullptr, 10);
+    else if (a == "--adc-fs-mv")   adcFsMv = strtof(next(), nullptr);
+    else if (a == "--wav-fs-mv")   wavFsMv = strtof(next(), nullptr);
+    else if (a == "--wav-bias-mv") wavBiasMv = strtof(next(), nullptr);
+    else if (a == "--dump")        dumpPath = next();
+    else if (a == "-h" || a == "--help") { usage(); return 0; }
+    else if (!a.empty() && a[0] == '-') { usage(); return 2; }
+    else inputs.push_back(argv[i]);
+  }
+  if (inputs.empty() || captureLen < FFT_SIZE || repeat == 0 || jobs == 0) { usage(); return 2; }
+  if ((level || minutes) && jobs > 1) {
+    fprintf(stderr, "[BENCH] --level/--minutes run single firmware instances: use --jobs 1\n");
+    return 2;
+  }
+  if (level && (!stream || FFT_QUIET_GATE)) {
+    fprintf(stderr, "[BENCH] --level meters every contiguous hop, as in CONTINUOUS mode: "
+                    "use --stream and a build with FFT_QUIET_GATE off\n");
+    return 2;
+  }
+  const size_t frameHops = captureLen / FFT_STEP_SIZE;
+
+  Serial.setQuiet(!verbose);
+
+  std::vector<Capture> caps;
+  for (const char* path : inputs) {
+    std::vector<uint8_t> buf;
+    Capture cap;
+    cap.name = path;
+    if (!readFile(path, buf)) { fprintf(stderr, "[BENCH] cannot read %s\n", path); return 1; }
+    bool isWav = !forceRaw && buf.size() >= 4 && memcmp(buf.data(), "RIFF", 4) == 0;
+    if (isWav) {
+      if (!loadWAV(buf, wavFsMv, wavBiasMv, cap)) return 1;
+    } else {
+      loadRaw(buf, cap);
+    }
+    caps.push_back(std::move(cap));
+  }
+
+  // Nominal linear transfer in place of the per-chip curve-fitting table
+  std::vector<float> rawToVolts(ADC_RAW_CODES);
+  for (int code = 0; code < ADC_RAW_CODES; ++code) {
+    float mv = (float)(int)((float)code * adcFsMv / (ADC_RAW_CODES - 1) + 0.5f);   // integer mV like adc_cali
+    rawToVolts[code] = mv / MV_TO_V_SCALE;
+  }
+
+  const ReplayOptions opt{ stream, captureLen, frameHops, rawToVolts.data(),
+                           dumpPath != nullptr, printFrames, check, level, minutes, codec };
+  if (level) {
+    initLevelMeter();
+    initLevelStats();
+  }
+  if (minutes) initMinuteSummary();
+  std::vector<ReplayResult> results(caps.size());
+  FFTStageTimes stages = {};
+  QuietGateStats gate = {};
+  uint64_t elapsedNs = 0;
+
+  if (jobs == 1) {
+    // Serial: every input through the default engine, detector state carried over
+    FFTEngine& eng = defaultFFTEngine();
+    if (!eng.init()) { fprintf(stderr, "[BENCH] initFFTEngine failed\n"); return 1; }
+    eng.resetStageTimes();
+    for (unsigned r = 0; r < repeat; ++r) {
+      for (size_t i = 0; i < caps.size(); ++i) replayCapture(eng, caps[i], opt, r == 0, results[i]);
+    }
+    addStageTimes(stages, eng.getStageTimes());
+    addGateStats(gate, eng.getGateStats());
+    eng.deinit();
+  } else {
+    // Parallel: one engine per input (independent detector state), N threads
+    std::atomic<size_t> nextCap{0};
+    std::atomic<bool> failed{false};
+    std::mutex stageLock;
+    uint64_t t0 = halNowNs();
+    std::vector<std::thread> pool;
+    for (unsigned j = 0; j < jobs; ++j) {
+      pool.emplace_back([&] {
+        for (size_t i = nextCap++; i < caps.size(); i = nextCap++) {
+          FFTEngine eng;
+          if (!eng.init()) { failed = true; return; }
+          for (unsigned r = 0; r < repeat; ++r) replayCapture(eng, caps[i], opt, r == 0, results[i]);
+          std::lock_guard<std::mutex> lock(stageLock);
+          addStageTimes(stages, eng.getStageTimes());
+          addGateStats(gate, eng.getGateStats());
+        }
+      });
+    }
+    for (std::thread& t : pool) t.join();
+    elapsedNs = halNowNs() - t0;
+    if (failed) { fprintf(stderr, "[BENCH] FFTEngine init failed\n"); return 1; }
+  }
+
+  uint64_t frames = 0, windows = 0, voiceFrames = 0, quietFrames = 0, audioSamples = 0;
+  uint64_t wallNs = 0, latencyNs = 0, levelNs = 0, levelSeconds = 0;
+  for (const ReplayResult& res : results) {
+    levelNs += res.levelNs;
+    levelSeconds += res.levels.size();
+    frames += res.frames;
+    windows += res.windows;
+    voiceFrames += res.voiceFrames;
+    quietFrames += res.quietFrames;
+    audioSamples += res.audioSamples;
+    wallNs += res.wallNs;
+    latencyNs += res.latencyNs;
+  }
+  if (jobs > 1) wallNs = elapsedNs;   // throughput across threads, not summed CPU time
+
+  if (printFrames) {
+    printf("file,frame,voice,snr,energy,peaks,contrast,intensity_db,dominant_hz,quiet,level_rms,zcr_hz,laeq_db\n");
+    for (const ReplayResult& res : results) fputs(res.csv.c_str(), stdout);
+    if (level) {
+      printf("file,second,laeq_db,lafmax_db,lafmin_db,lasmax_db,lasmin_db\n");
+      for (size_t i = 0; i < results.size(); ++i) {
+        for (size_t s = 0; s < results[i].levels.size(); ++s) {
+          const LevelSecond& l = results[i].levels[s];
+          printf("%s,%zu,%.2f,%.2f,%.2f,%.2f,%.2f\n", caps[i].name.c_str(), s,
+                 l.laeq, l.lafMax, l.lafMin, l.lasMax, l.lasMin);
+        }
+      }
+    }
+  }
+  if (minutes) {
+    std::vector<MinuteSummary> rows;
+    for (const ReplayResult& res : results) rows.insert(rows.end(), res.minutes.begin(), res.minutes.end());
+    MinuteSummary open;
+    if (minuteSummaryFlush(&open)) rows.push_back(open);
+    printf("minute_s,frames,voice_frames,quiet_frames,voice_rate,intensity_mean,voice_score_mean,"
+           "snr_mean,sfm_mean,noiseRMS_mean,bandRMS_mean,level_rms_mean\n");
+    for (const MinuteSummary& m : rows) {
+      printf("%llu,%u,%u,%u,%.4f,%.4f,%.4f,%.4f,%.4f,%.6g,%.6g,%.6g\n",
+             (unsigned long long)m.start, m.frames, m.voiceFrames, m.quietFrames,
+             m.frames ? (double)m.voiceFrames / m.frames : 0.0, m.intensityMean, m.voiceScoreMean,
+             m.snrMean, m.sfmMean, m.noiseRMSMean, m.bandRMSMean, m.levelRMSMean);
+    }
+  }
+  if (dumpPath) {
+    FILE* dump = openDump(dumpPath, (uint32_t)FFTEngine::getBins());
+    if (!dump) {
+      fprintf(stderr, "[BENCH] cannot write %s\n", dumpPath);
+      return 1;
+    }
+    for (const ReplayResult& res : results) {
+      fwrite(res.spectra.data(), sizeof(float), res.spectra.size(), dump);
+    }
+    fclose(dump);
+  }
+
+  if (frames == 0) {
+    fprintf(stderr, "[BENCH] no complete captures (need >= %zu samples per input)\n", captureLen);
+    return 1;
+  }
+
+  double wallS = wallNs / 1e9;
+  double audioS = (double)audioSamples / SAMPLE_RATE;
+  printf("[BENCH] FFT_SIZE=%d STEP=%d SAMPLE_RATE=%d capture=%zu (%.0f ms)\n",
+         FFT_SIZE, FFT_STEP_SIZE, SAMPLE_RATE, captureLen, 1000.0 * captureLen / SAMPLE_RATE);
+  printf("[BENCH] frames=%llu windows=%llu voice=%llu quiet=%llu repeat=%u jobs=%u\n",
+         (unsigned long long)frames, (unsigned long long)windows,
+         (unsigned long long)voiceFrames, (unsigned long long)quietFrames, repeat, jobs);
+  printf("[BENCH] wall=%.3f ms | frames/s=%.1f | ns/frame=%.0f | ns/FFT=%.0f | realtime x%.1f\n",
+         wallNs / 1e6, frames / wallS, (double)wallNs / frames, (double)wallNs / windows,
+         audioS / wallS);
+  printf("[BENCH] latency (last sample → features) %s: %.0f ns/frame\n",
+         stream ? "stream" : "batch", (double)latencyNs / frames);
+
+  if (!FFT_QUIET_GATE) {
+    printf("[GATE] quiet gate disabled (build with -DFFT_QUIET_GATE=ON)\n");
+  } else {
+    const uint64_t measured = (uint64_t)gate.windowsRun + gate.windowsSkipped;
+    printf("[GATE] windows run=%u skipped=%u (%.1f%%) | quiet frames=%u\n",
+           (unsigned)gate.windowsRun, (unsigned)gate.windowsSkipped,
+           measured ? 100.0 * gate.windowsSkipped / measured : 0.0, (unsigned)gate.quietFrames);
+  }
+
+  if (level) {
+    // Engine side (per-window A-weighted power) only measured in profiled builds
+    const LevelMeterStats ls = getLevelMeterStats();
+    const uint64_t meterNs = levelNs + stages.levelNs;
+    printf("[LEVEL] seconds=%llu | %.2f ns/sample (engine %.2f, meter %.2f) | %.1f%% of the FFT path\n",
+           (unsigned long long)levelSeconds, ls.samples ? (double)meterNs / ls.samples : 0.0,
+           ls.samples ? (double)stages.levelNs / ls.samples : 0.0,
+           ls.samples ? (double)levelNs / ls.samples : 0.0,
+           wallNs ? 100.0 * meterNs / wallNs : 0.0);
+
+    std::vector<LevelSummary> summaries;
+    for (const ReplayResult& res : results) {
+      summaries.insert(summaries.end(), res.summaries.begin(), res.summaries.end());
+    }
+    LevelSummary open[2];
+    summaries.insert(summaries.end(), open, open + levelStatsFlush(open));
+    for (const LevelSummary& s : summaries) {
+      printf("[LSTAT] %-6s t=%5llu s n=%4lu | L10=%.2f L50=%.2f L90=%.2f Leq=%.2f min=%.2f max=%.2f dB\n",
+             s.period == LevelPeriod::MINUTE ? "minute" : "hour", (unsigned long long)s.start,
+             (unsigned long)s.count, s.l10, s.l50, s.l90, s.leq, s.lmin, s.lmax);
+    }
+  }
+
+  const FFTStageTimes& st = stages;
+  if (st.windows == 0) {
+    printf("[STAGE] per-stage timing disabled (build with -DFFT_ENGINE_PROFILE=1)\n");
+  } else {
+    struct { const char* name; uint64_t ns; bool perFrame; } rows[] = {
+      { "input",     st.inputNs,     false },
+      { "fft",       st.fftNs,       false },
+      { "magnitude", st.magnitudeNs, false },
+      { "pool",      st.poolNs,      false },
+      { "level",     st.levelNs,     false },
+      { "features",  st.featureNs,   true  },
+    };
+    uint64_t total = 0;
+    for (auto& row : rows) total += row.ns;
+    for (auto& row : rows) {
+      double per = row.perFrame ? (double)row.ns / st.frames : (double)row.ns / st.windows;
+      printf("[STAGE] %-9s %10.0f ns/%s  %5.1f%%\n", row.name, per,
+             row.perFrame ? "frame" : "FFT  ", total ? 100.0 * row.ns / total : 0.0);
+    }
+  }
+
+  if (check) {
+    CheckResult c;
+    for (const ReplayResult& res : results) c.merge(res.check);
+    bool pass = c.energy <= CHECK_TOL_EXACT && c.snr <= CHECK_TOL_EXACT &&
+                c.contrast <= CHECK_TOL_EXACT && c.sfm <= CHECK_TOL_SFM && c.peakMismatches == 0;
+    printf("[CHECK] frames=%llu max rel diff: energy=%.3g snr=%.3g contrast=%.3g (tol %.0e) "
+           "sfm=%.3g (tol %.0e) | peak mismatches=%llu → %s\n",
+           (unsigned long long)c.frames, c.energy, c.snr, c.contrast, CHECK_TOL_EXACT,
+           c.sfm, CHECK_TOL_SFM, (unsigned long long)c.peakMismatches, pass ? "PASS" : "FAIL");
+    if (!pass) return 3;
+  }
+
+  if (codec) {
+    // Aligned record sizes as fft_logger.cpp writes them (512-byte sectors)
+    auto sectors = [](size_t bytes) { return ((bytes + 511) / 512) * 512; };
+    const size_t fft2Bytes = sectors(32 + FFT_BINS * 2 * sizeof(float));
+    for (size_t e = 0; e < CODEC_COUNT; ++e) {
+      CodecResult c;
+      for (const ReplayResult& res : results) c.merge(res.codec[e]);
+      const size_t bytes = sectors(64 + encodedSpectrumBytes(FFT_BINS, kCodecEncodings[e]));
+      printf("[CODEC] %-4s %5zu B/frame (FFT2 %zu, x%.1f) | frames=%llu max|a-b|/peak=%.3g | "
+             "max rel diff: energy=%.3g snr=%.3g contrast=%.3g sfm=%.3g | peak mismatches=%llu\n",
+             kCodecEncodings[e] == FFT3_ENC_F16 ? "f16" : "log8", bytes, fft2Bytes,
+             (double)fft2Bytes / bytes, (unsigned long long)c.drift.frames, c.maxErr,
+             c.drift.energy, c.drift.snr, c.drift.contrast, c.drift.sfm,
+             (unsigned long long)c.drift.peakMismatches);
+    }
+  }
+
+  return 0;
+}
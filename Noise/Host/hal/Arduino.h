@@ -0,0 +1,58 @@
+#pragma once
+
+// Host (Linux) stand-in for the subset of Arduino-ESP32 used by the
+// portable firmware modules (fft_engine.cpp; fft_logger.cpp and sd_backend.cpp
+// with the sdsim/ card). Not a general Arduino core.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <stdarg.h>
+
+#define IRAM_ATTR
+#define RTC_DATA_ATTR
+
+// === Time ===
+uint64_t halNowNs();
+uint32_t millis();
+uint32_t micros();
+void delay(uint32_t ms);
+// Simulated time (log_sim): the clocks above run ahead by the total advanced
+void halAdvanceMs(uint32_t ms);
+
+// Profiling clock used by FFT_ENGINE_PROFILE (ns resolution on host)
+#define FFT_PROFILE_NOW_NS() halNowNs()
+
+// === FreeRTOS bits the modules touch ===
+typedef uint32_t TickType_t;
+typedef void* TaskHandle_t;
+#define portTICK_PERIOD_MS 1
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+void vTaskDelay(TickType_t ticks);
+
+// === GPIO (no-ops: the SD backends park their pins) ===
+#define INPUT  0x01
+#define OUTPUT 0x03
+#define LOW    0
+#define HIGH   1
+inline void pinMode(uint8_t, uint8_t) {}
+inline void digitalWrite(uint8_t, uint8_t) {}
+
+// === Serial → stderr (keeps stdout clean for bench output) ===
+class HostSerial {
+public:
+  void begin(unsigned long) {}
+  int printf(const char* fmt, ...) __attribute__((format(printf, 2, 3)));
+  size_t print(const char* s);
+  size_t println(const char* s = "");
+  size_t print(char c);
+  void setQuiet(bool q) { quiet = q; }
+
+private:
+  bool quiet = false;
+};
+
+extern HostSerial Serial;
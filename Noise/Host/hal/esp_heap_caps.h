@@ -0,0 +1,15 @@
+#pragma once
+
+// Host stand-in for ESP-IDF heap_caps: every capability maps to malloc().
+
+#include <stdlib.h>
+#include <stdint.h>
+
+#define MALLOC_CAP_SPIRAM    (1u << 10)
+#define MALLOC_CAP_INTERNAL  (1u << 11)
+#define MALLOC_CAP_8BIT      (1u << 2)
+#define MALLOC_CAP_DMA       (1u << 3)
+
+static inline void* heap_caps_malloc(size_t size, uint32_t) { return malloc(size); }
+static inline void* heap_caps_calloc(size_t n, size_t size, uint32_t) { return calloc(n, size); }
+static inline size_t heap_caps_get_free_size(uint32_t) { return 0; }
@@ -0,0 +1,16 @@
+#pragma once
+
+// Host stand-in for the FreeRTOS subset used by the FFT lane worker
+// (FFT_PARALLEL). Tasks are std::threads; core pinning is ignored.
+
+#include "Arduino.h"
+
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+
+#define pdTRUE  1
+#define pdFALSE 0
+#define pdPASS  1
+#define pdFAIL  0
+#define portMAX_DELAY ((TickType_t)0xFFFFFFFFu)
+#define tskNO_AFFINITY 0x7FFFFFFF
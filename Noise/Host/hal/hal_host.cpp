@@ -0,0 +1,107 @@
+#include "Arduino.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+HostSerial Serial;
+
+static const auto halEpoch = std::chrono::steady_clock::now();
+static std::atomic<uint64_t> halAdvancedNs{ 0 };
+
+uint64_t halNowNs() {
+  return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+           std::chrono::steady_clock::now() - halEpoch).count() + halAdvancedNs.load();
+}
+
+void halAdvanceMs(uint32_t ms) { halAdvancedNs += (uint64_t)ms * 1000000ULL; }
+
+uint32_t millis() { return (uint32_t)(halNowNs() / 1000000ULL); }
+uint32_t micros() { return (uint32_t)(halNowNs() / 1000ULL); }
+
+void delay(uint32_t ms) { std::this_thread::sleep_for(std::chrono::milliseconds(ms)); }
+
+void vTaskDelay(TickType_t ticks) {
+  // Firmware uses vTaskDelay(0) as a WDT-friendly yield; nothing to feed on host.
+  if (ticks == 0) return;
+  std::this_thread::sleep_for(std::chrono::milliseconds(ticks * portTICK_PERIOD_MS));
+}
+
+// === FreeRTOS tasks / binary semaphores ===
+namespace {
+struct TaskExit {};   // thrown by vTaskDelete(nullptr), caught at the thread root
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char* /*name*/, uint32_t /*stackDepth*/,
+                                   void* arg, UBaseType_t /*priority*/, TaskHandle_t* handle,
+                                   BaseType_t /*core*/) {
+  std::thread t([fn, arg] {
+    try { fn(arg); } catch (const TaskExit&) {}
+  });
+  if (handle) *handle = (TaskHandle_t)(uintptr_t)std::hash<std::thread::id>{}(t.get_id());
+  t.detach();
+  return pdPASS;
+}
+
+void vTaskDelete(TaskHandle_t task) {
+  if (task == nullptr) throw TaskExit{};
+}
+
+struct HostSemaphore {
+  std::mutex m;
+  std::condition_variable cv;
+  bool given = false;
+};
+
+SemaphoreHandle_t xSemaphoreCreateBinary() { return new HostSemaphore; }
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem) {
+  std::lock_guard<std::mutex> lock(sem->m);
+  if (sem->given) return pdFALSE;
+  sem->given = true;
+  sem->cv.notify_one();
+  return pdTRUE;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks) {
+  std::unique_lock<std::mutex> lock(sem->m);
+  auto ready = [sem] { return sem->given; };
+  if (ticks == portMAX_DELAY) {
+    sem->cv.wait(lock, ready);
+  } else if (!sem->cv.wait_for(lock, std::chrono::milliseconds(ticks * portTICK_PERIOD_MS), ready)) {
+    return pdFALSE;
+  }
+  sem->given = false;
+  return pdTRUE;
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t sem) { delete sem; }
+
+int HostSerial::printf(const char* fmt, ...) {
+  if (quiet) return 0;
+  va_list ap;
+  va_start(ap, fmt);
+  int n = vfprintf(stderr, fmt, ap);
+  va_end(ap);
+  return n;
+}
+
+size_t HostSerial::print(const char* s) {
+  if (quiet || !s) return 0;
+  return fputs(s, stderr) >= 0 ? strlen(s) : 0;
+}
+
+size_t HostSerial::print(char c) {
+  if (quiet) return 0;
+  return fputc(c, stderr) == EOF ? 0 : 1;
+}
+
+size_t HostSerial::println(const char* s) {
+  size_t n = print(s);
+  if (!quiet) fputc('\n', stderr);
+  return n + 1;
+}
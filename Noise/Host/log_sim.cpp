@@ -0,0 +1,383 @@
+// Host simulation of the SD logger (fft_logger.cpp, sd_backend.cpp) on an
+// in-memory card (sdsim/), with the frame rate of the default burst cycle.
+//
+// Every cycle logs one frame (FFT2, every 7th quiet as FFTQ) and one LVL1
+// record, as loggerTask does, and advances the clock by --cycle-ms. Frames
+// are numbered through their first magnitude (FFTQ: level RMS, LVL1: LAeq),
+// so each scenario parses the card afterwards and checks which frames
+// survived, in which order, with their records intact.
+//
+//   log_sim [--frames N] [--cycle-ms MS] [--verbose]
+//
+//   stream    N frames: write count and size, index updates per frame
+//   reboot    deinit + init halfway: frames resume in order, nothing lost
+//   pull      card pulled for a few cycles (mounts, opens, writes fail) and
+//             reinserted: everything before the last flush survives, every
+//             frame after the reinsertion follows in order
+//   rollover  MAX_LOG_FILE_SIZE is 1 MB in these builds: several files,
+//             each readable on its own (LOGH range, FGRD if compact)
+//   window    LOG_XXXX.IDX entries point at frame records with their
+//             timestamp, and a binary-searched window parses the same frames
+//             as a full scan (log_index.py's seek_window())
+//
+// Exit status 3 if a scenario fails. Card write speed is not modelled: the
+// MB/s and per-write latency of the [SD] report need a kit.
+
+#include "Arduino.h"
+#include <FS.h>   // String (sdsim)
+#include "signal_config.h"
+#include "fft_engine.h"
+#include "fft_logger.h"
+#include "sd_sim.h"
+#include "wifi_manager.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+// wifi_manager.cpp stand-ins for the logger's time gate
+bool isTimeSynced() { return true; }
+String getFormattedTime() { return String("sim"); }
+
+static const uint64_t SIM_T0 = 1760000000;   // unix time of frame 0
+static const uint32_t SECTOR = 512;
+
+static size_t alignedUp(size_t n) { return (n + SECTOR - 1) / SECTOR * SECTOR; }
+template <class T> static T rd(const sdsim::Blob& b, size_t at) { T v; memcpy(&v, b.data() + at, sizeof(T)); return v; }
+
+// === Driving the logger ===
+struct Run {
+  uint32_t cycleMs = 1500;
+  int next = 0;                  // number of the next frame
+  std::vector<float> mags;
+};
+
+static uint64_t frameTime(const Run& run, int n) { return SIM_T0 + (uint64_t)n * run.cycleMs / 1000; }
+
+// One cycle; false if the logger refused a record (then recovered, as loggerTask does)
+static bool cycle(Run& run) {
+  const int n = run.next++;
+  FFTFeatures ft = {};
+  ft.quiet = (n % 7 == 3);
+  ft.levelRMS = (float)n;
+  ft.snr = 2.0f;
+  std::fill(run.mags.begin(), run.mags.end(), 0.001f);
+  run.mags[0] = (float)n;
+  const uint64_t ts = frameTime(run, n);
+  LevelSecond sec = { ts, (float)n, 0, 0, 0, 0, SAMPLE_RATE };
+
+  bool ok = saveFFTFrame(getFFTFrequencies(), run.mags.data(), run.mags.size(), ft, ts) &&
+            saveLevelSeconds(&sec, 1);
+  if (!ok) recoverFFTLogger();
+  halAdvanceMs(run.cycleMs);
+  return ok;
+}
+
+// === Reading the card back ===
+struct Record {
+  char magic[5];
+  int frame;          // frame number, -1 for records without one
+  uint64_t ts;
+  uint32_t offset;
+};
+
+struct LogFile {
+  std::string name;
+  uint32_t first = 0, end = 0;
+  std::vector<Record> records;
+  bool ok = true;
+  std::string error;
+};
+
+static LogFile parseLog(const std::string& name, uint32_t from = 0, uint32_t to = UINT32_MAX) {
+  LogFile lf;
+  lf.name = name;
+  const sdsim::Blob* b = sdsim::file(name);
+  if (!b) { lf.ok = false; lf.error = "missing"; return lf; }
+  lf.end = (uint32_t)b->size();
+  if (b->size() >= SECTOR && memcmp(b->data(), "LOGH", 4) == 0) {
+    lf.first = SECTOR;
+    lf.end = std::min<uint32_t>(rd<uint32_t>(*b, 12), lf.end);
+  }
+  uint32_t off = std::max(lf.first, from);
+  const uint32_t end = std::min(lf.end, to);
+  while (off + 32 <= end) {
+    Record r = {};
+    memcpy(r.magic, b->data() + off, 4);
+    r.frame = -1;
+    r.offset = off;
+    size_t size = SECTOR;
+    if (!strcmp(r.magic, "FFT2")) {
+      const uint16_t bins = rd<uint16_t>(*b, off + 27);
+      r.ts = rd<uint64_t>(*b, off + 4);
+      r.frame = (int)rd<float>(*b, off + 32 + 4);
+      size = alignedUp(32 + bins * 8);
+    } else if (!strcmp(r.magic, "FFTQ")) {
+      r.ts = rd<uint64_t>(*b, off + 4);
+      r.frame = (int)rd<float>(*b, off + 12);
+    } else if (!strcmp(r.magic, "LVL1")) {
+      r.ts = rd<uint64_t>(*b, off + 32);
+      r.frame = (int)rd<float>(*b, off + 40);
+      size = alignedUp(32 + b->data()[off + 4] * 32);
+    } else if (!strcmp(r.magic, "FGRD")) {
+      size = alignedUp(32 + rd<uint16_t>(*b, off + 14) * 4);
+    } else if (strcmp(r.magic, "LSUM") && strcmp(r.magic, "VSUM")) {
+      lf.ok = false;
+      lf.error = "unknown record at " + std::to_string(off);
+      break;
+    }
+    lf.records.push_back(r);
+    off += size;
+  }
+  return lf;
+}
+
+static std::vector<std::string> logFiles() {
+  std::vector<std::string> names;
+  for (const auto& kv : sdsim::card.files) {
+    if (kv.first.size() == 13 && kv.first.compare(0, 5, "/LOG_") == 0 && kv.first.compare(9, 4, ".BIN") == 0) {
+      names.push_back(kv.first);
+    }
+  }
+  return names;   // map order: by index
+}
+
+// Frame numbers in card order, LVL1 checked against its frame
+static bool readFrames(std::vector<int>& frames, std::string& error, const Run& run) {
+  frames.clear();
+  for (const std::string& name : logFiles()) {
+    LogFile lf = parseLog(name);
+    if (!lf.ok) { error = name + ": " + lf.error; return false; }
+    int open = -1;   // frame waiting for its LVL1
+    for (const Record& r : lf.records) {
+      if (r.frame < 0) continue;
+      if (!strcmp(r.magic, "LVL1")) {
+        if (r.frame != open) { error = name + ": LVL1 of frame " + std::to_string(r.frame) + " out of place"; return false; }
+        open = -1;
+        continue;
+      }
+      if (r.ts != frameTime(run, r.frame)) { error = name + ": frame " + std::to_string(r.frame) + " has the wrong timestamp"; return false; }
+      frames.push_back(r.frame);
+      open = r.frame;
+    }
+  }
+  return true;
+}
+
+// Sorted, no duplicates, and [0, n) minus the numbers in [lostFrom, lostTo)
+static bool expectFrames(const std::vector<int>& frames, int n, int lostFrom, int lostTo, std::string& error) {
+  std::vector<int> want;
+  for (int i = 0; i < n; ++i) if (i < lostFrom || i >= lostTo) want.push_back(i);
+  if (frames == want) return true;
+  size_t k = 0;
+  while (k < frames.size() && k < want.size() && frames[k] == want[k]) ++k;
+  error = "frame list differs at position " + std::to_string(k) + " (got " +
+          (k < frames.size() ? std::to_string(frames[k]) : std::string("end")) + ", expected " +
+          (k < want.size() ? std::to_string(want[k]) : std::string("end")) + ")";
+  return false;
+}
+
+// === Scenarios ===
+struct Result {
+  const char* name;
+  bool pass;
+  std::string detail;
+};
+
+static void freshCard(Run& run) {
+  deinitFFTLogger();
+  sdsim::reset();
+  run.next = 0;
+}
+
+static Result stream(Run& run, int frames) {
+  freshCard(run);
+  if (!initFFTLogger()) return { "stream", false, "init failed" };
+  const LoggerWriteStats s0 = getLoggerWriteStats();
+  for (int i = 0; i < frames; ++i) {
+    if (!cycle(run)) return { "stream", false, "save failed at frame " + std::to_string(i) };
+  }
+  const LoggerWriteStats s = getLoggerWriteStats();
+  deinitFFTLogger();
+
+  std::vector<int> got;
+  std::string error;
+  if (!readFrames(got, error, run) || !expectFrames(got, frames, 0, 0, error)) return { "stream", false, error };
+  const uint32_t writes = s.writes - s0.writes;
+  const uint32_t updates = s.indexUpdates - s0.indexUpdates;
+  char buf[200];
+  snprintf(buf, sizeof(buf), "%d frames in %.0f s | record writes=%u avg=%.1f KB | index updates=%u (one per %.1f frames)",
+           frames, frames * run.cycleMs / 1000.0, (unsigned)writes,
+           writes ? (s.bytes - s0.bytes) / 1024.0 / writes : 0.0, (unsigned)updates,
+           updates ? (double)frames / updates : 0.0);
+  return { "stream", true, buf };
+}
+
+static Result reboot(Run& run, int frames) {
+  freshCard(run);
+  if (!initFFTLogger()) return { "reboot", false, "init failed" };
+  for (int i = 0; i < frames; ++i) {
+    if (i == frames / 2) {
+      deinitFFTLogger();
+      if (!initFFTLogger()) return { "reboot", false, "init after reboot failed" };
+    }
+    if (!cycle(run)) return { "reboot", false, "save failed at frame " + std::to_string(i) };
+  }
+  deinitFFTLogger();
+  std::vector<int> got;
+  std::string error;
+  if (!readFrames(got, error, run) || !expectFrames(got, frames, 0, 0, error)) return { "reboot", false, error };
+  return { "reboot", true, std::to_string(got.size()) + " frames, resumed at frame " + std::to_string(frames / 2) };
+}
+
+static Result pull(Run& run, int frames) {
+  freshCard(run);
+  if (!initFFTLogger()) return { "pull", false, "init failed" };
+  const int pullAt = frames / 2, pullCycles = 5;
+  int firstFailed = -1, reinserted = -1;
+  for (int i = 0; i < frames; ++i) {
+    if (i == pullAt) sdsim::card.pulled = true;
+    if (i == pullAt + pullCycles) sdsim::card.pulled = false;
+    const bool ok = cycle(run);
+    if (!ok && firstFailed < 0) firstFailed = i;
+    if (ok && firstFailed >= 0 && reinserted < 0) reinserted = i;
+  }
+  deinitFFTLogger();
+  if (firstFailed < 0 || reinserted < 0) return { "pull", false, "the pull went unnoticed" };
+
+  std::vector<int> got;
+  std::string error;
+  if (!readFrames(got, error, run)) return { "pull", false, error };
+  // Lost: from the first frame not on the card up to the first saved after reinsertion
+  int lostFrom = 0;
+  while (lostFrom < (int)got.size() && got[lostFrom] == lostFrom) ++lostFrom;
+  if (lostFrom > pullAt) return { "pull", false, "frames logged while the card was out" };
+  if (!expectFrames(got, frames, lostFrom, reinserted, error)) return { "pull", false, error };
+  return { "pull", true, "card out for frames " + std::to_string(pullAt) + "-" + std::to_string(pullAt + pullCycles - 1) +
+           ", lost " + std::to_string(reinserted - lostFrom) + " (from " + std::to_string(lostFrom) + ")" };
+}
+
+static Result rollover(Run& run, int frames) {
+  freshCard(run);
+  if (!initFFTLogger()) return { "rollover", false, "init failed" };
+  for (int i = 0; i < frames; ++i) {
+    if (i == frames / 3) {
+      deinitFFTLogger();
+      if (!initFFTLogger()) return { "rollover", false, "init after reboot failed" };
+    }
+    if (!cycle(run)) return { "rollover", false, "save failed at frame " + std::to_string(i) };
+  }
+  deinitFFTLogger();
+  const size_t files = logFiles().size();
+  if (files < 3) return { "rollover", false, "only " + std::to_string(files) + " log files: raise --frames" };
+  std::vector<int> got;
+  std::string error;
+  if (!readFrames(got, error, run) || !expectFrames(got, frames, 0, 0, error)) return { "rollover", false, error };
+  return { "rollover", true, std::to_string(files) + " files of " + std::to_string(MAX_LOG_FILE_SIZE >> 10) + " KB" };
+}
+
+// Frame records of name within [from, to) with ts in [t0, t1)
+static std::vector<int> framesIn(const std::string& name, uint64_t t0, uint64_t t1, uint32_t from, uint32_t to) {
+  std::vector<int> out;
+  for (const Record& r : parseLog(name, from, to).records) {
+    if (r.frame >= 0 && strcmp(r.magic, "LVL1") && r.ts >= t0 && r.ts < t1) out.push_back(r.frame);
+  }
+  return out;
+}
+
+static Result window(Run& run, int frames) {
+  freshCard(run);
+  if (!initFFTLogger()) return { "window", false, "init failed" };
+  for (int i = 0; i < frames; ++i) {
+    if (i == frames / 2) {
+      deinitFFTLogger();
+      if (!initFFTLogger()) return { "window", false, "init after reboot failed" };
+    }
+    if (!cycle(run)) return { "window", false, "save failed at frame " + std::to_string(i) };
+  }
+  deinitFFTLogger();
+#if LOG_INDEX_EVERY > 0
+  size_t entries = 0, windows = 0;
+  uint64_t scanned = 0, total = 0;
+  const uint64_t span = frameTime(run, frames);
+  for (const std::string& name : logFiles()) {
+    const std::string idxName = name.substr(0, 9) + ".IDX";
+    const sdsim::Blob* idx = sdsim::file(idxName);
+    if (!idx || idx->size() < 16 || memcmp(idx->data(), "LIDX", 4) != 0) return { "window", false, idxName + " missing" };
+    const LogFile lf = parseLog(name);
+    std::vector<uint64_t> ts;
+    std::vector<uint32_t> offsets;
+    for (size_t at = 16; at + 16 <= idx->size(); at += 16) {
+      ts.push_back(rd<uint64_t>(*idx, at));
+      offsets.push_back(rd<uint32_t>(*idx, at + 8));
+      auto r = std::find_if(lf.records.begin(), lf.records.end(),
+                            [&](const Record& x) { return x.offset == offsets.back(); });
+      if (r == lf.records.end() || r->ts != ts.back() || !strcmp(r->magic, "LVL1")) {
+        return { "window", false, idxName + ": entry " + std::to_string(ts.size() - 1) + " does not point at its frame" };
+      }
+      if (ts.size() > 1 && (ts.back() < ts[ts.size() - 2] || offsets.back() <= offsets[offsets.size() - 2])) {
+        return { "window", false, idxName + ": entries out of order" };
+      }
+    }
+    entries += ts.size();
+
+    // Windows of 1..40 s across the whole run
+    for (uint64_t t0 = SIM_T0; t0 < span; t0 += 7) {
+      const uint64_t t1 = t0 + 1 + (t0 % 40);
+      const size_t i = std::lower_bound(ts.begin(), ts.end(), t0) - ts.begin();
+      const size_t j = std::lower_bound(ts.begin(), ts.end(), t1) - ts.begin();
+      const uint32_t lo = i > 0 ? offsets[i - 1] : lf.first;
+      const uint32_t hi = j < ts.size() ? offsets[j] : lf.end;
+      if (framesIn(name, t0, t1, lo, hi) != framesIn(name, t0, t1, 0, UINT32_MAX)) {
+        return { "window", false, name + ": window at +" + std::to_string(t0 - SIM_T0) + " s differs from a full scan" };
+      }
+      scanned += hi - lo;
+      total += lf.end - lf.first;
+      windows++;
+    }
+  }
+  char buf[160];
+  snprintf(buf, sizeof(buf), "%zu index entries (every %d frames), %zu windows read %.1f%% of a full scan",
+           entries, LOG_INDEX_EVERY, windows, total ? 100.0 * scanned / total : 0.0);
+  return { "window", true, buf };
+#else
+  return { "window", true, "LOG_INDEX_EVERY is 0: no sidecar" };
+#endif
+}
+
+static void usage() {
+  fprintf(stderr, "usage: log_sim [--frames N] [--cycle-ms MS] [--verbose]\n");
+}
+
+int main(int argc, char** argv) {
+  Run run;
+  int frames = 240;
+  bool verbose = false;
+  for (int i = 1; i < argc; ++i) {
+    const std::string a = argv[i];
+    if (a == "--frames" && i + 1 < argc)        frames = atoi(argv[++i]);
+    else if (a == "--cycle-ms" && i + 1 < argc) run.cycleMs = (uint32_t)atoi(argv[++i]);
+    else if (a == "--verbose")                  verbose = true;
+    else if (a == "-h" || a == "--help")        { usage(); return 0; }
+    else                                        { usage(); return 2; }
+  }
+  if (frames < 30 || run.cycleMs == 0) { usage(); return 2; }
+  Serial.setQuiet(!verbose);
+
+  initFFTEngine();
+  run.mags.resize(getFFTBins());
+  printf("[LOGSIM] staging=%s chunk=%lu KB age=%u ms | prealloc=%s | index every %d | file %lu KB | cycle %u ms\n",
+         LOG_STAGING_ENABLED ? "on" : "off", (unsigned long)(LOG_FLUSH_CHUNK >> 10), (unsigned)LOG_FLUSH_AGE_MS,
+         LOG_PREALLOCATE ? "on" : "off", LOG_INDEX_EVERY, (unsigned long)(MAX_LOG_FILE_SIZE >> 10),
+         (unsigned)run.cycleMs);
+
+  const Result results[] = { stream(run, frames), reboot(run, frames), pull(run, frames),
+                             rollover(run, frames), window(run, frames) };
+  bool pass = true;
+  for (const Result& r : results) {
+    printf("[LOGSIM] %-8s %s | %s\n", r.name, r.pass ? "PASS" : "FAIL", r.detail.c_str());
+    pass = pass && r.pass;
+  }
+  deinitFFTLogger();
+  return pass ? 0 : 3;
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+// In-memory stand-in for Arduino-ESP32's FS / SD / SD_MMC (see sd_sim.h).
+// Files live in a map keyed by path; handles share the data and keep their
+// own position, with the fopen() modes the logger uses ("r", "w", "a", "r+").
+
+#include "Arduino.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+#define FILE_READ   "r"
+#define FILE_WRITE  "w"
+#define FILE_APPEND "a"
+
+class String : public std::string {
+public:
+  using std::string::string;
+  String() = default;
+  String(const std::string& s) : std::string(s) {}
+  long toInt() const { return atol(c_str()); }
+  String substring(size_t from, size_t to) const { return String(substr(from, to - from)); }
+};
+
+namespace fs {
+
+class File {
+public:
+  File() = default;
+  File(std::shared_ptr<std::vector<uint8_t>> data, std::string path, size_t pos)
+    : data(std::move(data)), path(std::move(path)), pos(pos) {}
+  static File directory(std::vector<std::string> entries);
+
+  explicit operator bool() const { return data != nullptr || isDir; }
+  size_t write(const uint8_t* buf, size_t size);
+  int read(uint8_t* buf, size_t size);
+  bool seek(uint32_t p) { pos = p; return true; }
+  size_t position() const { return pos; }
+  size_t size() const { return data ? data->size() : 0; }
+  void flush() {}
+  void close() { data.reset(); isDir = false; }
+  const char* name() const { return path.c_str(); }
+  bool isDirectory() const { return isDir; }
+  File openNextFile();
+  String readString();
+  int printf(const char* fmt, ...) __attribute__((format(printf, 2, 3)));
+
+private:
+  std::shared_ptr<std::vector<uint8_t>> data;
+  std::string path;
+  size_t pos = 0;
+  bool isDir = false;
+  std::vector<std::string> entries;   // directory handles
+  size_t next = 0;
+};
+
+class FS {
+public:
+  File open(const char* path, const char* mode = FILE_READ);
+  bool exists(const char* path);
+  bool remove(const char* path);
+  bool rename(const char* from, const char* to);
+};
+
+}  // namespace fs
+
+using fs::File;
+using fs::FS;
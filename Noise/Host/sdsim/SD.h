@@ -0,0 +1,15 @@
+#pragma once
+#include "FS.h"
+#include "SPI.h"
+
+typedef enum { CARD_NONE, CARD_MMC, CARD_SD, CARD_SDHC, CARD_UNKNOWN } sdcard_type_t;
+
+class SDFS : public fs::FS {
+public:
+  bool begin(uint8_t ssPin, SPIClass& spi, uint32_t frequency, const char* mountpoint = "/sd");
+  void end() {}
+  sdcard_type_t cardType() { return CARD_SDHC; }
+  uint64_t cardSize();
+};
+
+extern SDFS SD;
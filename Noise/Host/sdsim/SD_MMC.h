@@ -0,0 +1,16 @@
+#pragma once
+#include "FS.h"
+#include "SD.h"   // sdcard_type_t
+
+class SDMMCFS : public fs::FS {
+public:
+  bool setPins(int, int, int) { return true; }
+  bool setPins(int, int, int, int, int, int) { return true; }
+  bool begin(const char* mountpoint = "/sdcard", bool mode1bit = false,
+             bool formatIfMountFailed = false, int frequency = 20000);
+  void end() {}
+  sdcard_type_t cardType() { return CARD_SDHC; }
+  uint64_t cardSize();
+};
+
+extern SDMMCFS SD_MMC;
@@ -0,0 +1,10 @@
+#pragma once
+#include <stdint.h>
+
+class SPIClass {
+public:
+  void begin(int8_t, int8_t, int8_t, int8_t) {}
+  void end() {}
+};
+
+extern SPIClass SPI;
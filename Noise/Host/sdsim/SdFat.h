@@ -0,0 +1,17 @@
+#pragma once
+// formatSDCard() only: the simulated card cannot be formatted (newCard() fails)
+#include <stdint.h>
+#include <stddef.h>
+
+#define SHARED_SPI 0
+#define SD_SCK_MHZ(mhz) ((mhz) * 1000000UL)
+
+struct SdSpiConfig { SdSpiConfig(int, int, uint32_t) {} };
+struct SdCard {
+  int errorCode() { return 1; }
+  uint32_t sectorCount() { return 0; }
+  bool erase(uint32_t, uint32_t) { return false; }
+};
+struct SdCardFactory { SdCard* newCard(SdSpiConfig) { return nullptr; } };
+struct FatFormatter { template <class P> bool format(SdCard*, uint8_t*, P*) { return false; } };
+struct ExFatFormatter { template <class P> bool format(SdCard*, uint8_t*, P*) { return false; } };
@@ -0,0 +1,13 @@
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef int esp_err_t;
+#define ESP_OK   0
+#define ESP_FAIL -1
+
+// Creates the file at its full size, filled with stale card data (sd_sim.cpp)
+esp_err_t esp_vfs_fat_create_contiguous_file(const char* basePath, const char* fullPath,
+                                             uint64_t size, bool allocNow);
+esp_err_t esp_vfs_fat_test_contiguous_file(const char* basePath, const char* fullPath,
+                                           bool* isContiguous);
@@ -0,0 +1,141 @@
+#include "sd_sim.h"
+#include "SD.h"
+#include "SD_MMC.h"
+#include "SPI.h"
+#include "esp_vfs_fat.h"
+
+#include <algorithm>
+#include <random>
+
+namespace sdsim {
+
+Card card;
+
+void reset() { card = Card{}; }
+
+const Blob* file(const std::string& path) {
+  auto it = card.files.find(path);
+  return it == card.files.end() ? nullptr : it->second.get();
+}
+
+}  // namespace sdsim
+
+using sdsim::card;
+
+SDFS SD;
+SDMMCFS SD_MMC;
+SPIClass SPI;
+
+static const uint64_t SIM_CARD_BYTES = 32ULL << 30;
+
+bool SDFS::begin(uint8_t, SPIClass&, uint32_t, const char*) { return !card.pulled; }
+uint64_t SDFS::cardSize() { return SIM_CARD_BYTES; }
+bool SDMMCFS::begin(const char*, bool, bool, int) { return card.sdmmc && !card.pulled; }
+uint64_t SDMMCFS::cardSize() { return SIM_CARD_BYTES; }
+
+// === Files ===
+namespace fs {
+
+File File::directory(std::vector<std::string> entries) {
+  File d;
+  d.isDir = true;
+  d.path = "/";
+  d.entries = std::move(entries);
+  return d;
+}
+
+size_t File::write(const uint8_t* buf, size_t size) {
+  if (!data || card.pulled) return 0;
+  if (pos + size > data->size()) data->resize(pos + size);
+  memcpy(data->data() + pos, buf, size);
+  pos += size;
+  card.writes++;
+  card.bytes += size;
+  return size;
+}
+
+int File::read(uint8_t* buf, size_t size) {
+  if (!data || pos >= data->size()) return 0;
+  const size_t n = std::min(size, data->size() - pos);
+  memcpy(buf, data->data() + pos, n);
+  pos += n;
+  return (int)n;
+}
+
+File File::openNextFile() {
+  if (!isDir || next >= entries.size()) return File();
+  const std::string& p = entries[next++];
+  return File(card.files[p], p, 0);
+}
+
+String File::readString() {
+  if (!data || pos >= data->size()) return String();
+  String s(data->begin() + pos, data->end());
+  pos = data->size();
+  return s;
+}
+
+int File::printf(const char* fmt, ...) {
+  char buf[128];
+  va_list ap;
+  va_start(ap, fmt);
+  const int n = vsnprintf(buf, sizeof(buf), fmt, ap);
+  va_end(ap);
+  return n > 0 ? (int)write((const uint8_t*)buf, std::min<size_t>(n, sizeof(buf) - 1)) : n;
+}
+
+File FS::open(const char* path, const char* mode) {
+  const std::string p = path, m = mode;
+  if (card.pulled) return File();
+  if (p == "/") {
+    std::vector<std::string> entries;
+    for (const auto& kv : card.files) entries.push_back(kv.first);
+    return File::directory(std::move(entries));
+  }
+  auto it = card.files.find(p);
+  if (m == "r" || m == "r+") {
+    return it == card.files.end() ? File() : File(it->second, p, 0);
+  }
+  if (it == card.files.end()) {
+    it = card.files.emplace(p, std::make_shared<sdsim::Blob>()).first;
+  } else if (m == "w") {
+    it->second->clear();   // fopen("w") truncates
+  }
+  return File(it->second, p, m == "a" ? it->second->size() : 0);
+}
+
+bool FS::exists(const char* path) { return card.files.count(path) > 0; }
+
+bool FS::remove(const char* path) { return card.files.erase(path) > 0; }
+
+bool FS::rename(const char* from, const char* to) {
+  auto it = card.files.find(from);
+  if (it == card.files.end()) return false;
+  card.files[to] = it->second;
+  card.files.erase(from);
+  return true;
+}
+
+}  // namespace fs
+
+// === esp_vfs_fat ===
+// "/sd/LOG_0000.BIN" → "/LOG_0000.BIN"
+static std::string stripMount(const char* basePath, const char* fullPath) {
+  const std::string full = fullPath, base = basePath;
+  return full.compare(0, base.size(), base) == 0 ? full.substr(base.size()) : full;
+}
+
+esp_err_t esp_vfs_fat_create_contiguous_file(const char* basePath, const char* fullPath,
+                                             uint64_t size, bool) {
+  if (card.pulled) return ESP_FAIL;
+  auto blob = std::make_shared<sdsim::Blob>(size);
+  std::mt19937 stale(0x5D);   // whatever the clusters held before
+  for (auto& b : *blob) b = (uint8_t)stale();
+  card.files[stripMount(basePath, fullPath)] = blob;
+  return ESP_OK;
+}
+
+esp_err_t esp_vfs_fat_test_contiguous_file(const char*, const char*, bool* isContiguous) {
+  *isContiguous = true;
+  return ESP_OK;
+}
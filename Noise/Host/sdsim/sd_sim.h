@@ -0,0 +1,29 @@
+#pragma once
+
+// Controls and inspection of the in-memory card behind sdsim/'s SD, SD_MMC
+// and esp_vfs_fat stand-ins.
+
+#include <stdint.h>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace sdsim {
+
+using Blob = std::vector<uint8_t>;
+
+struct Card {
+  std::map<std::string, std::shared_ptr<Blob>> files;   // "/LOG_0000.BIN" → data
+  bool pulled = false;       // card out: mounts, opens and writes fail
+  bool sdmmc = false;        // SD_MMC.begin() succeeds (SDMMC wired)
+  uint32_t writes = 0;       // write() calls that stored data
+  uint64_t bytes = 0;
+};
+
+extern Card card;
+
+void reset();
+const Blob* file(const std::string& path);   // nullptr if missing
+
+}  // namespace sdsim